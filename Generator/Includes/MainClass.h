@@ -10,7 +10,12 @@
 #ifndef MAINCLASS_H_
 #define MAINCLASS_H_
 
+#include <map>
+#include <memory>
+#include <functional>
+
 #include "AMain.h"
+#include "DatasetFile.hpp"
 
 class MainClass : public AMain {
 
@@ -27,9 +32,16 @@ private:
     void generator_and(int count) const;
     void generator_or(int count) const;
     void generator_xor(int count) const;
+    void printTopology(std::string const &layers) const;
+    void printSample(std::vector<int> const &inputs, int target) const;
+    void printOutput(int target) const;
 
 private:
     std::map <std::string, std::function<void(int count)>> _generators;
+    bool _softmax;
+    std::string _binary;
+    Neural::DatasetFile::Precision _precision;
+    mutable std::unique_ptr<Neural::DatasetFile::Writer> _writer;
 
 };
 
@@ -10,6 +10,8 @@
 #include "MainClass.h"
 
 MainClass::MainClass(int argc, char *argv[]): AMain(argc, argv, "MainClass") {
+    this->_softmax = false;
+    this->_precision = Neural::DatasetFile::Float32;
 
 }
 
@@ -23,7 +25,10 @@ ArgParser::parser MainClass::setupArgParser() const {
         { "help", {"-h", "--help"}, "Shows this help message.\n", 0},
         { "type", {"-t", "--type"}, KRED + "[required]" + KNRM + " Specify the generator type.\n", 1},
         { "count", {"-c", "--count"}, "            Specify how many example the data set will contains." + KYEL + "\n\tdefault: 50000\n" + KNRM, 1},
-        { "list_type", {"-l", "--list"}, "            List all project type possibilities.\n", 0}
+        { "list_type", {"-l", "--list"}, "            List all project type possibilities.\n", 0},
+        { "softmax", {"-s", "--softmax"}, "            Write one-hot targets (0 or 1 as two classes) for a softmax output layer.\n", 0},
+        { "binary", {"-b", "--binary"}, "            Write the data set to this path in the binary data set format instead of printing it.\n", 1},
+        { "precision", {"-p", "--precision"}, "            Precision of the binary data set: float64 or float32." + KYEL + "\n\tdefault: float32\n" + KNRM, 1}
     }};
 }
 
@@ -43,7 +48,16 @@ bool MainClass::Run(ArgParser::parser_results const &args) {
         return false;
     }
 
+    this->_softmax = args["softmax"];
+    if (args["binary"]) {
+        this->_binary = args["binary"].as<std::string>();
+        this->_precision = Neural::DatasetFile::parsePrecision(args["precision"].as<std::string>("float32"));
+    }
     this->_generators[args["type"].as<std::string>()](args["count"].as<int>(50000));
+    if (this->_writer) {
+        this->_writer->close();
+        this->logger.info() << "Wrote " << this->_writer->getSampleCount() << " samples to " << this->_binary;
+    }
 
     return true;
 }
@@ -72,37 +86,64 @@ bool MainClass::checkArgument(ArgParser::parser_results const &args) const {
 
 void MainClass::generator_and(int count) const {
     // random traning sets for AND -- two inputs and one output
-	std::cout << "topology: 2 4 1" << std::endl;
+	this->printTopology("2 4");
 	for (int i = count; i > 0; --i) {
 		int n1 = (int)(2.0 * rand() / double(RAND_MAX));
 		int n2 = (int)(2.0 * rand() / double(RAND_MAX));
         int t = n1 && n2; // should be 0 or 1
-		std::cout << "in: " << n1 << ".0 " << n2 << ".0 " << std::endl;
-		std::cout << "out: " << t << ".0" << std::endl;
+		this->printSample({n1, n2}, t);
 	}
 }
 
 void MainClass::generator_or(int count) const {
     // random traning sets for OR -- three inputs and one output
-	std::cout << "topology: 3 4 1" << std::endl;
+	this->printTopology("3 4");
 	for (int i = count; i > 0; --i) {
 		int n1 = (int)(2.0 * rand() / double(RAND_MAX));
 		int n2 = (int)(2.0 * rand() / double(RAND_MAX));
         int n3 = (int)(2.0 * rand() / double(RAND_MAX));
 		int t = n1 || n2 || n3; // should be 0 or 1
-		std::cout << "in: " << n1 << ".0 " << n2 << ".0 " << n3 << ".0 " << std::endl;
-		std::cout << "out: " << t << ".0" << std::endl;
+		this->printSample({n1, n2, n3}, t);
 	}
 }
 
 void MainClass::generator_xor(int count) const {
     // random traning sets for XOR -- two inputs and one output
-    std::cout << "topology: 2 4 8 4 1" << std::endl;
+    this->printTopology("2 4 8 4");
     for (int i = count; i > 0; --i) {
         int n1 = (int)(2.0 * rand() / double(RAND_MAX));
         int n2 = (int)(2.0 * rand() / double(RAND_MAX));
         int t = n1 ^ n2; // should be 0 or 1
-        std::cout << "in: " << n1 << ".0 " << n2 << ".0 " << std::endl;
-        std::cout << "out: " << t << ".0" << std::endl;
+        this->printSample({n1, n2}, t);
+    }
+}
+
+void MainClass::printTopology(std::string const &layers) const {
+    // The output layer is a single tanh neuron, or one softmax neuron per class
+    std::string topology = layers + (this->_softmax ? " 2 softmax" : " 1");
+    if (!this->_binary.empty())
+        this->_writer.reset(new Neural::DatasetFile::Writer(this->_binary, topology, this->_precision));
+    else
+        std::cout << "topology: " << topology << std::endl;
+}
+
+void MainClass::printSample(std::vector<int> const &inputs, int target) const {
+    if (this->_writer) {
+        std::vector<double> output = this->_softmax ? std::vector<double> {target ? 0.0 : 1.0, target ? 1.0 : 0.0} : std::vector<double> {(double)target};
+        this->_writer->add(std::vector<double>(inputs.begin(), inputs.end()), output);
+        return;
+    }
+    std::cout << "in: ";
+    for (int input: inputs) {
+        std::cout << input << ".0 ";
     }
+    std::cout << std::endl;
+    this->printOutput(target);
+}
+
+void MainClass::printOutput(int target) const {
+    if (this->_softmax)
+        std::cout << "out: " << (target ? "0.0 1.0" : "1.0 0.0") << std::endl;
+    else
+        std::cout << "out: " << target << ".0" << std::endl;
 }
@@ -12,7 +12,16 @@
 
 #include "AMain.h"
 #include "NetworkTrainer.hpp"
+#include "StreamingTrainer.hpp"
+#include "MappedTrainer.hpp"
+#include "PrefetchTrainer.hpp"
 #include "Network.hpp"
+#include "NetworkPruner.hpp"
+#include "GraphNetwork.hpp"
+#include "CompiledNetwork.hpp"
+#include "SampleStream.hpp"
+#include "Checkpointer.hpp"
+#include "InferenceServer.hpp"
 
 class MainClass : public AMain {
 
@@ -26,6 +35,11 @@ protected:
 
 private:
     bool checkArgument(ArgParser::parser_results const &args) const;
+    void trainStream(ArgParser::parser_results const &args, Neural::Network &network, Neural::Initializer const &initializer, Neural::Checkpointer *checkpointer) const;
+    void exportNetwork(ArgParser::parser_results const &args, Neural::Network const &network) const;
+    void benchParse(std::string const &path) const;
+    void convertDataset(std::string const &from, std::string const &to, Neural::DatasetFile::Precision precision) const;
+    static std::string headerNamespace(std::string const &path);
 
 };
 
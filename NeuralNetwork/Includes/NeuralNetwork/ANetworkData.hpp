@@ -12,26 +12,43 @@
 
 #include <sstream>
 #include <fstream>
+#include <memory>
 
 #include "NetworkException.hpp"
+#include "Topology.hpp"
+#include "Initializer.hpp"
+#include "ThreadPool.hpp"
 #include "Layer.hpp"
+#include "BatchNorm.hpp"
+#include "ModelFile.hpp"
 
 namespace Neural {
 
     class ANetworkData {
 
     public:
-        ANetworkData(const std::vector<unsigned> &topology, double recentAverageSmoothingFactor);
+        ANetworkData(const Topology &topology, double recentAverageSmoothingFactor, Initializer const &initializer = Initializer());
         ~ANetworkData();
         ANetworkData(const ANetworkData &data);
         ANetworkData &operator =(const ANetworkData &data);
 
         virtual void loadFrom(const ANetworkData &data);
-        virtual void loadFrom(const std::string &filepath);
+        virtual void loadFrom(const std::string &filepath); // text or binary model
+        virtual void loadFrom(const ModelFile &file);
         virtual void saveTo(const std::string &file) const;
+        virtual void saveBinary(const std::string &file) const;
+        // Binary model for inference only, batch norm folded, without the deltas nor the training progress
+        virtual void exportWeights(const std::string &file, ModelFile::Precision precision = ModelFile::Float32) const;
+        // Flat copy of the parameters, the vectors of a reused content are not reallocated
+        virtual void snapshot(ModelFile::Content &content) const;
+        virtual void removeNeuron(unsigned layerNum, unsigned neuronNum, double constantOutput = 0.0);
+        virtual void foldBatchNorm();
 
         virtual double getRecentAverageError(void) const;
+        virtual Topology getTopology() const;
         virtual std::vector<Neural::Layer> const &getLayer() const;
+        virtual std::vector<std::unique_ptr<ITransformLayer>> const &getTransforms() const;
+        virtual std::vector<std::vector<BatchNorm>> const &getBatchNorms() const;
         virtual unsigned getLayerCount() const;
         virtual unsigned getInputCount() const;
         virtual unsigned getOutputCount() const;
@@ -39,16 +56,25 @@ namespace Neural {
         virtual unsigned getConnectionCount() const;
 
     protected:
+        std::vector<std::unique_ptr<ITransformLayer>> _transforms; // applied in order before _layers
         std::vector<Layer> _layers; // _layers[layerNum][neuronNum]
+        Topology::Loss _loss;
+        std::vector<double> _dropout; // rate per layer, only used while training
+        std::vector<std::vector<BatchNorm>> _batchNorms; // [layerNum][neuronNum], empty for layers without batchnorm
+        uint64_t _seed;
+        Random _random; // generator of the transform layers, seeded by build()
         double _error;
         std::vector<double> _errorHistory;
         double _recentAverageError;
         double _recentAverageSmoothingFactor;
 
     private:
-        std::vector<unsigned> readTopology(std::ifstream &file) const;
+        void build(const Topology &topology, double recentAverageSmoothingFactor, uint64_t seed);
+        void initialize(Initializer const &initializer);
+        Topology readTopology(std::ifstream &file) const;
         std::vector<double> readError(std::ifstream &file) const;
-        void readNextNeuron(std::ifstream &file, std::vector<unsigned> &coord, Neural::INeuron::Connection &data) const;
+        void readBatchNorm(std::string const &line, std::string const &filepath);
+        void readNextNeuron(std::string const &line, std::vector<unsigned> &coord, Neural::INeuron::Connection &data) const;
 
     };
 
@@ -0,0 +1,62 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   15/05/2018 09:36:52
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 15/05/2018 18:04:19
+ */
+
+
+#ifndef BATCHNORM_HPP_
+#define BATCHNORM_HPP_
+
+#include <cmath>
+
+#include "Neuron.hpp"
+
+namespace Neural {
+
+    // Normalization of one neuron sum before its transfer function:
+    // y = gamma * (sum - mean) / sqrt(variance + epsilon) + beta
+    // The network is trained one sample at a time, so mean and variance are running
+    // averages updated while training and frozen otherwise.
+    // For inference y = scale * sum + shift, which folds into the incoming weights.
+    class BatchNorm {
+
+    public:
+        BatchNorm(double momentum = 0.01, double epsilon = 1e-5, double eta = 0.15, double alpha = 0.5);
+        ~BatchNorm();
+        BatchNorm(const BatchNorm &batchNorm);
+        BatchNorm &operator =(const BatchNorm &batchNorm);
+
+        double forward(double sum, bool training);
+        double infer(double sum) const; // forward with the frozen statistics, leaves the layer untouched
+        // Takes the gradient at y, trains gamma and beta, returns the gradient at the sum
+        double backward(double gradient);
+
+        double getScale() const;
+        double getShift() const;
+        INeuron::Connection const &getGamma() const;
+        INeuron::Connection const &getBeta() const;
+        double getMean() const;
+        double getVariance() const;
+        void setState(INeuron::Connection const &gamma, INeuron::Connection const &beta, double mean, double variance);
+
+    private:
+        double _momentum;
+        double _epsilon;
+        double _eta;
+        double _alpha;
+        INeuron::Connection _gamma;
+        INeuron::Connection _beta;
+        double _mean;
+        double _variance;
+        double _normalized; // last (sum - mean) / sqrt(variance + epsilon)
+
+        void update(INeuron::Connection &parameter, double gradient);
+
+    };
+
+}
+
+#endif /*BATCHNORM_HPP_*/
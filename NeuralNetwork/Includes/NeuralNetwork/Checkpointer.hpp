@@ -0,0 +1,74 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   18/05/2018 09:02:44
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 18/05/2018 15:26:10
+ */
+
+
+#ifndef CHECKPOINTER_HPP_
+#define CHECKPOINTER_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "Network.hpp"
+
+namespace Neural {
+
+    // Saves a network every interval samples or every period seconds, whichever comes first.
+    // The training thread only copies the parameters into a recycled network of the same shape,
+    // which reuses every neuron buffer. A background thread lays the copy out in the binary model
+    // format, writes it to path.tmp, syncs it, then renames it over path, so the file on disk is
+    // always a complete network. The copy keeps the training progress, a run resumes from the file.
+    // Only the latest copy waits to be written, an older one still pending is recycled.
+    class Checkpointer {
+
+    public:
+        Checkpointer(std::string const &path, unsigned long interval = 10000, double period = 60.0);
+        ~Checkpointer();
+        Checkpointer(const Checkpointer &checkpointer) = delete;
+        Checkpointer &operator =(const Checkpointer &checkpointer) = delete;
+
+        // Called after every trained sample
+        void sample(Network const &network);
+        void save(Network const &network);
+        // Waits until the last copy is on disk, rethrows the error of a failed write
+        void flush();
+
+        std::string const &getPath() const;
+        unsigned long getSaved() const;
+
+    private:
+        std::string _path;
+        unsigned long _interval;
+        std::chrono::duration<double> _period;
+        unsigned long _samples;
+        std::chrono::steady_clock::time_point _last;
+
+        mutable std::mutex _mutex;
+        std::condition_variable _wake;
+        std::condition_variable _written;
+        std::unique_ptr<Network> _pending;
+        std::unique_ptr<Network> _spare;    // receives the next copy
+        ModelFile::Content _content;        // writer thread only
+        bool _writing;
+        bool _stop;
+        unsigned long _saved;
+        std::exception_ptr _error;
+        std::thread _worker;
+
+        void run();
+        void write(Network const &network);
+
+    };
+
+}
+
+#endif /*CHECKPOINTER_HPP_*/
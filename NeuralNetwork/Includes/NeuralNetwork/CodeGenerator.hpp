@@ -0,0 +1,61 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   08/05/2018 11:12:40
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 08/05/2018 16:38:55
+ */
+
+
+#ifndef CODEGENERATOR_HPP_
+#define CODEGENERATOR_HPP_
+
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <cstdint>
+#include <cctype>
+
+#include "NetworkException.hpp"
+#include "OperatorGraph.hpp"
+
+namespace Neural {
+
+    class ICodeGenerator {
+
+    public:
+        virtual ~ICodeGenerator() {};
+
+        virtual std::string generateSource() const = 0;
+        virtual std::string generateHeader(std::string const &name) const = 0;
+        virtual std::uint64_t getHash() const = 0;
+
+    };
+
+    // Emits C++ source with the weights and the topology of a fused graph baked in as constants
+    class CodeGenerator : public ICodeGenerator {
+
+    public:
+        CodeGenerator(OperatorGraph const &graph);
+        ~CodeGenerator();
+        CodeGenerator(const CodeGenerator &generator);
+        CodeGenerator &operator =(const CodeGenerator &generator);
+
+        std::string generateSource() const;
+        std::string generateHeader(std::string const &name) const;
+        std::uint64_t getHash() const;
+
+        OperatorGraph const &getGraph() const;
+
+    private:
+        OperatorGraph _graph;
+
+        void emitWeights(std::ostream &os, std::string const &qualifier) const;
+        void emitForward(std::ostream &os, std::string const &input, std::string const &output) const;
+        void emitArray(std::ostream &os, std::vector<double> const &values) const;
+
+    };
+
+}
+
+#endif /*CODEGENERATOR_HPP_*/
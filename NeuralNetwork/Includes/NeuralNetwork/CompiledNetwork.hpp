@@ -0,0 +1,69 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   08/05/2018 14:02:17
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 08/05/2018 16:39:03
+ */
+
+
+#ifndef COMPILEDNETWORK_HPP_
+#define COMPILEDNETWORK_HPP_
+
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "Network.hpp"
+#include "CodeGenerator.hpp"
+
+namespace Neural {
+
+    // A trained Network specialized into a shared object by the host compiler.
+    // Objects are cached in cacheDirectory under the hash of their source.
+    class CompiledNetwork : public INetwork {
+
+    public:
+        CompiledNetwork(Network const &network, std::string const &cacheDirectory = "./.neural_cache");
+        ~CompiledNetwork();
+        CompiledNetwork(const CompiledNetwork &network);
+        CompiledNetwork &operator =(const CompiledNetwork &network);
+
+        void train(INetworkTrainer const &trainer);
+        void feedForward(const std::vector<double> &inputVals);
+        std::vector<double> const getResults() const;
+        void backProp(const std::vector<double> &targetVals);
+
+        void errorPlot() const;
+
+        std::string const &getLibraryPath() const;
+        bool isFromCache() const;
+
+    private:
+        typedef void (*PredictFunction)(const double *, double *);
+        typedef unsigned (*CountFunction)();
+
+        Network _network;
+        std::string _libraryPath;
+        bool _fromCache;
+        void *_handle;
+        PredictFunction _predict;
+        unsigned _inputCount;
+        unsigned _outputCount;
+        std::vector<double> _results;
+
+        void compile(CodeGenerator const &generator, std::string const &cacheDirectory);
+        void open();
+        void close();
+        static bool run(std::vector<std::string> const &arguments);
+
+    };
+
+}
+
+#endif /*COMPILEDNETWORK_HPP_*/
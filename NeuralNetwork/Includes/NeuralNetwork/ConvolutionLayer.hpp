@@ -0,0 +1,62 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   10/05/2018 13:47:36
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 10/05/2018 18:52:51
+ */
+
+
+#ifndef CONVOLUTIONLAYER_HPP_
+#define CONVOLUTIONLAYER_HPP_
+
+#include "TransformLayer.hpp"
+
+namespace Neural {
+
+    // Valid 2D convolution with stride 1 followed by tanh.
+    // 3x3 kernels run a direct unrolled kernel, other sizes go through im2col + GEMM.
+    class ConvolutionLayer : public ATransformLayer {
+
+    public: enum Algorithm {
+            Auto,
+            Gemm,
+            Direct
+        };
+
+    public:
+        ConvolutionLayer(Shape const &inputShape, unsigned filters, unsigned kernel, Random &random, Algorithm algorithm = Auto);
+        ~ConvolutionLayer();
+        ConvolutionLayer(const ConvolutionLayer &layer);
+        ConvolutionLayer &operator =(const ConvolutionLayer &layer);
+
+        static Shape outputShape(Shape const &inputShape, unsigned filters, unsigned kernel);
+
+        std::string getDescription() const;
+        void feedForward(const std::vector<double> &input);
+        void backProp(const std::vector<double> &outputGradients);
+        void predict(const std::vector<double> &input, std::vector<double> &output, std::vector<double> &scratch) const;
+        ITransformLayer *clone() const;
+
+        bool isDirect() const;
+
+    private:
+        unsigned _filters;
+        unsigned _kernel;
+        Algorithm _algorithm;
+        std::vector<double> _input;
+        std::vector<double> _columns;   // im2col matrix, [channels * kernel * kernel][outputPixels]
+        std::vector<double> _gradients;
+
+        void forward(const double *input, double *output, std::vector<double> &columns) const;
+        void im2col(const double *input, std::vector<double> &columns) const;
+        void forwardGemm(const double *input, double *output, std::vector<double> &columns) const;
+        void forwardDirect3x3(const double *input, double *output) const;
+        void backwardGemm();
+        void backwardDirect();
+
+    };
+
+}
+
+#endif /*CONVOLUTIONLAYER_HPP_*/
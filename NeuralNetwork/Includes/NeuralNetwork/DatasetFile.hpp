@@ -0,0 +1,109 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   23/05/2018 10:04:26
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 23/05/2018 18:12:50
+ */
+
+
+#ifndef DATASETFILE_HPP_
+#define DATASETFILE_HPP_
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "NetworkException.hpp"
+
+namespace Neural {
+
+    // Binary data set, mapped in memory and read in place.
+    // [header 64 bytes][topology brief][inputs][outputs]
+    // The inputs are a row major [samples][inputs] matrix and the outputs a [samples][outputs] one,
+    // both in float64 or float32 in the byte order of the writer and on a 64 bytes boundary.
+    // It only depends on NetworkException, so that the Generator can write it too.
+    class DatasetFile {
+
+    public: enum Precision {
+            Float64,
+            Float32
+        };
+
+    private:
+        struct Header {
+            char magic[8];
+            uint32_t version;
+            uint32_t byteOrder;
+            uint64_t fileSize;
+            uint64_t sampleCount;
+            uint32_t topologySize;
+            uint32_t precision;
+            uint32_t inputs;
+            uint32_t outputs;
+            uint64_t inputsOffset;
+            uint64_t outputsOffset;
+        };
+
+    // Writes the samples as they come: the inputs go straight to the file, the outputs are kept
+    // in memory until close() puts them after the inputs.
+    public: class Writer {
+
+        public:
+            Writer(std::string const &path, std::string const &topology, Precision precision = Float32);
+            ~Writer();
+            Writer(const Writer &writer) = delete;
+            Writer &operator =(const Writer &writer) = delete;
+
+            // Every sample has the inputs and outputs count of the first one
+            void add(std::vector<double> const &input, std::vector<double> const &output);
+            void close();
+            uint64_t getSampleCount() const;
+
+        private:
+            std::string _path;
+            std::ofstream _file;
+            Header _header;
+            std::vector<unsigned char> _row;
+            std::vector<unsigned char> _outputs;
+            bool _closed;
+
+            void encode(std::vector<double> const &values, unsigned char *data) const;
+
+        };
+
+    public:
+        static const uint32_t Version = 1;
+
+        DatasetFile(std::string const &path);
+        ~DatasetFile();
+        DatasetFile(const DatasetFile &file) = delete;
+        DatasetFile &operator =(const DatasetFile &file) = delete;
+
+        static bool isDatasetFile(std::string const &path);
+        static Precision parsePrecision(std::string const &name);
+
+        std::string getTopologyBrief() const;
+        uint64_t getSampleCount() const;
+        unsigned getInputCount() const;
+        unsigned getOutputCount() const;
+        Precision getPrecision() const;
+        // Replaces the content of input and output with the values of the sample
+        void getSample(uint64_t index, std::vector<double> &input, std::vector<double> &output) const;
+
+    private:
+        std::string _path;
+        const unsigned char *_data;
+        size_t _size;
+        const Header *_header;
+
+        static uint64_t align(uint64_t offset);
+        static uint64_t elementSize(uint32_t precision);
+        void decode(uint64_t offset, unsigned count, std::vector<double> &values) const;
+
+    };
+
+}
+
+#endif /*DATASETFILE_HPP_*/
@@ -0,0 +1,66 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   22/05/2018 09:47:12
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 22/05/2018 16:30:41
+ */
+
+
+#ifndef DATASETPARSER_HPP_
+#define DATASETPARSER_HPP_
+
+#include <string>
+#include <vector>
+
+#include "NetworkException.hpp"
+#include "Topology.hpp"
+
+namespace Neural {
+
+    // Text data set mapped in memory and parsed in place with std::from_chars, nothing is
+    // allocated per line: values are appended to vectors the caller keeps between samples.
+    // The format and its errors are the ones of the "topology:" / "in:" / "out:" files,
+    // the samples end at the first line that is not an "in:" line with values.
+    // A parser may be given a range of the file, several of them then read one file at once.
+    class DatasetParser {
+
+    public:
+        DatasetParser(std::string const &path);
+        ~DatasetParser();
+        DatasetParser(const DatasetParser &parser) = delete;
+        DatasetParser &operator =(const DatasetParser &parser) = delete;
+
+        Topology const &getTopology() const;
+        // Appends the inputs then the outputs of the next sample, false once the samples are over
+        bool next(std::vector<double> &values, unsigned &inputs, unsigned &outputs);
+        bool next(std::vector<double> &input, std::vector<double> &output);
+        // Bytes of the file read so far, out of getSize()
+        size_t getPosition() const;
+        size_t getSize() const;
+        // Start of the first "in:" line at or after position, getSize() if there is none
+        size_t findRecord(size_t position) const;
+        // Reads the samples whose "in:" line starts in [begin, end[ only, begin must start a line
+        void setRange(size_t begin, size_t end);
+        // True once a line that is not a sample was met, the samples are over there
+        bool hasStopped() const;
+
+    private:
+        std::string _path;
+        const char *_data;
+        size_t _size;
+        const char *_cursor;
+        const char *_end;
+        bool _done;
+        bool _eof;
+        unsigned _inputs;
+        Topology _topology;
+
+        bool sample(std::vector<double> &input, std::vector<double> &output);
+        void readLine(const char *label, std::vector<double> &values);
+
+    };
+
+}
+
+#endif /*DATASETPARSER_HPP_*/
@@ -0,0 +1,49 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   13/05/2018 09:42:08
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 13/05/2018 15:26:40
+ */
+
+
+#ifndef EMBEDDINGLAYER_HPP_
+#define EMBEDDINGLAYER_HPP_
+
+#include "TransformLayer.hpp"
+
+namespace Neural {
+
+    // Table lookup of integer ids, every input value is an id in [0..vocabulary[
+    // and is replaced by its row of dimension values, the output shape is [ids][dimension].
+    // Only the rows of the ids seen by the last feedForward are updated by backProp.
+    class EmbeddingLayer : public ATransformLayer {
+
+    public:
+        EmbeddingLayer(Shape const &inputShape, unsigned vocabulary, unsigned dimension, Random &random);
+        ~EmbeddingLayer();
+        EmbeddingLayer(const EmbeddingLayer &layer);
+        EmbeddingLayer &operator =(const EmbeddingLayer &layer);
+
+        static Shape outputShape(Shape const &inputShape, unsigned vocabulary, unsigned dimension);
+
+        std::string getDescription() const;
+        void feedForward(const std::vector<double> &input);
+        void backProp(const std::vector<double> &outputGradients);
+        void predict(const std::vector<double> &input, std::vector<double> &output, std::vector<double> &scratch) const;
+        ITransformLayer *clone() const;
+
+    private:
+        unsigned _vocabulary;
+        unsigned _dimension;
+        std::vector<unsigned> _ids;       // ids of the last feedForward
+        std::vector<unsigned> _touched;   // distinct ids of the last feedForward
+        std::vector<double> _gradients;   // [vocabulary][dimension], only the touched rows are non zero
+
+        void lookup(const std::vector<double> &input, double *output, unsigned *ids) const;
+
+    };
+
+}
+
+#endif /*EMBEDDINGLAYER_HPP_*/
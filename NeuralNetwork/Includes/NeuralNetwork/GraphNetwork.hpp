@@ -0,0 +1,58 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   06/05/2018 17:05:33
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 06/05/2018 19:47:10
+ */
+
+
+#ifndef GRAPHNETWORK_HPP_
+#define GRAPHNETWORK_HPP_
+
+#include "Network.hpp"
+#include "OperatorGraph.hpp"
+
+namespace Neural {
+
+    // Runs the forward pass of a Network through its fused operator graph,
+    // training still goes through the neuron based Network it wraps.
+    class GraphNetwork : public INetwork {
+
+    public:
+        GraphNetwork(Network const &network, bool fused = true);
+        GraphNetwork(Network const &network, std::vector<double> const &inputMean, std::vector<double> const &inputDeviation, bool fused = true);
+        ~GraphNetwork();
+        GraphNetwork(const GraphNetwork &network);
+        GraphNetwork &operator =(const GraphNetwork &network);
+
+        void train(INetworkTrainer const &trainer);
+        void feedForward(const std::vector<double> &inputVals);
+        std::vector<double> const getResults() const;
+        void backProp(const std::vector<double> &targetVals);
+
+        void errorPlot() const;
+        void dump(std::ostream &os) const;
+
+        Network const &getNetwork() const;
+        OperatorGraph const &getGraph() const;
+
+    private:
+        Network _network;
+        OperatorGraph _graph;
+        bool _fused;
+        bool _normalized;
+        bool _dirty;
+        std::vector<double> _inputMean;
+        std::vector<double> _inputDeviation;
+        std::vector<double> _lastInput;
+        std::vector<double> _results;
+        std::vector<double> _scratch;
+
+        void rebuild();
+
+    };
+
+}
+
+#endif /*GRAPHNETWORK_HPP_*/
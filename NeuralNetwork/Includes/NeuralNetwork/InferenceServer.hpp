@@ -0,0 +1,126 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   19/05/2018 10:33:18
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 19/05/2018 21:05:52
+ */
+
+
+#ifndef INFERENCESERVER_HPP_
+#define INFERENCESERVER_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "NetworkException.hpp"
+#include "Network.hpp"
+#include "OperatorGraph.hpp"
+#include "ThreadPool.hpp"
+
+namespace Neural {
+
+    // Serves a network over a unix ("/path") or TCP ("[host:]port") socket.
+    // Every request is one line, "in: x1 x2 ..." is answered by "out: y1 y2 ..." or "error: ...",
+    // "stats:" by the counters of the server. A connection may pipeline its requests, they are
+    // answered in order.
+    // One thread reads every connection, the requests of all clients are queued and gathered in
+    // batches of at most maxBatch samples. A batch leaves when it is full or when its oldest
+    // request waited maxLatency, and only once a worker is idle so that it grows under load.
+    // Dense networks run the batched kernels of the fused operator graph, the others
+    // Network::predict with one workspace per worker.
+    class InferenceServer {
+
+    public: struct Options {
+            unsigned maxBatch;
+            unsigned maxLatency;        // microseconds
+            unsigned threads;           // 0 is one worker per core
+
+            Options(unsigned maxBatch = 32, unsigned maxLatency = 1000, unsigned threads = 0);
+        };
+
+    public: struct Stats {
+            uint64_t requests;
+            uint64_t batches;
+            double p50;                 // microseconds from the request line to its answer
+            double p99;
+        };
+
+    private:
+        struct Connection {
+            int fd;
+            std::string received;       // reader thread only
+            uint64_t sequence;          // reader thread only, number of the next request
+            std::mutex mutex;
+            uint64_t sent;              // number of the next answer to write
+            std::map<uint64_t, std::string> ready;
+            std::string unsent;         // answers the socket did not take yet, the poll thread writes them
+
+            Connection(int fd);
+            ~Connection();
+        };
+
+        struct Request {
+            std::shared_ptr<Connection> connection;
+            uint64_t sequence;
+            std::vector<double> input;
+            std::chrono::steady_clock::time_point arrival;
+        };
+
+    public:
+        InferenceServer(Network const &network, Options const &options = Options());
+        ~InferenceServer();
+        InferenceServer(const InferenceServer &server) = delete;
+        InferenceServer &operator =(const InferenceServer &server) = delete;
+
+        void listen(std::string const &address);
+        // Serves until stop() is called from another thread
+        void run();
+        void stop();
+
+        Stats getStats() const;
+        std::string const &getAddress() const;
+
+    private:
+        Network _network;
+        std::unique_ptr<OperatorGraph> _graph;
+        Options _options;
+        std::string _address;
+        int _server;
+        int _wake[2];
+        std::atomic<bool> _stop;
+
+        std::mutex _mutex;
+        std::condition_variable _queued;
+        std::condition_variable _idle;
+        std::deque<Request> _queue;
+        unsigned _busy;
+        std::unique_ptr<ThreadPool> _pool;
+
+        std::atomic<uint64_t> _requests;
+        std::atomic<uint64_t> _batches;
+        std::array<std::atomic<uint64_t>, 256> _latencies; // 8 buckets per power of two microseconds
+
+        void read(std::shared_ptr<Connection> const &connection, std::vector<std::shared_ptr<Connection>> &closed);
+        void request(std::shared_ptr<Connection> const &connection, std::string const &line);
+        void batch();
+        void process(std::vector<Request> &batch);
+        void answer(Connection &connection, uint64_t sequence, std::string const &text);
+        void flush(Connection &connection);
+        void record(std::chrono::steady_clock::time_point arrival);
+        double percentile(double rank) const;
+
+    };
+
+}
+
+#endif /*INFERENCESERVER_HPP_*/
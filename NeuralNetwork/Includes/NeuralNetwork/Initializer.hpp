@@ -0,0 +1,50 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   14/05/2018 11:27:40
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 14/05/2018 17:48:31
+ */
+
+
+#ifndef INITIALIZER_HPP_
+#define INITIALIZER_HPP_
+
+#include <string>
+
+#include "NetworkException.hpp"
+#include "Random.hpp"
+
+namespace Neural {
+
+    // Initial weights of the fully connected layers
+    class Initializer {
+
+    public: enum Scheme {
+            Uniform, // [0.0..1.0], the original behaviour
+            Xavier,  // uniform in +-sqrt(6 / (fanIn + fanOut)), suited to tanh
+            He       // normal with deviation sqrt(2 / fanIn)
+        };
+
+    public:
+        Initializer(Scheme scheme = Xavier, uint64_t seed = Random::DefaultSeed);
+        ~Initializer();
+        Initializer(const Initializer &initializer);
+        Initializer &operator =(const Initializer &initializer);
+
+        Scheme getScheme() const;
+        uint64_t getSeed() const;
+        double weight(Random &random, unsigned fanIn, unsigned fanOut) const;
+        double bias(Random &random) const;
+
+        static Scheme parse(std::string const &name);
+
+    private:
+        Scheme _scheme;
+        uint64_t _seed;
+
+    };
+
+}
+
+#endif /*INITIALIZER_HPP_*/
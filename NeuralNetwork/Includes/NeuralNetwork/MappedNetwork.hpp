@@ -0,0 +1,55 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   20/05/2018 16:04:51
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 20/05/2018 19:41:27
+ */
+
+
+#ifndef MAPPEDNETWORK_HPP_
+#define MAPPEDNETWORK_HPP_
+
+#include <list>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <algorithm>
+
+#include "NetworkException.hpp"
+#include "ModelFile.hpp"
+#include "BatchNorm.hpp"
+
+namespace Neural {
+
+    // Inference straight from the weights of a binary model file, nothing is copied or parsed:
+    // opening a model only maps it, its pages are read on first use and shared between processes.
+    // Reduced precision weights are the exception, they are decoded to doubles when opened.
+    // Fully connected networks only, the others are loaded with ANetworkData::loadFrom.
+    // predict is const and can be called from any number of threads.
+    class MappedNetwork {
+
+    public:
+        MappedNetwork(std::string const &path, bool verify = true);
+        ~MappedNetwork();
+        MappedNetwork(const MappedNetwork &network) = delete;
+        MappedNetwork &operator =(const MappedNetwork &network) = delete;
+
+        void predict(const std::vector<double> &input, std::vector<double> &output, std::vector<double> &scratch) const;
+
+        Topology const &getTopology() const;
+        unsigned getInputCount() const;
+        unsigned getOutputCount() const;
+
+    private:
+        ModelFile _file;
+        Topology _topology;
+        std::vector<const double *> _weights; // [layerNum] row major [outputs][inputs + bias], in the mapping
+        std::list<std::vector<double>> _decoded; // reduced precision weights, they never move
+        std::vector<std::vector<BatchNorm>> _batchNorms;
+
+    };
+
+}
+
+#endif /*MAPPEDNETWORK_HPP_*/
@@ -0,0 +1,50 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   23/05/2018 14:31:08
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 23/05/2018 18:12:50
+ */
+
+
+#ifndef MAPPEDTRAINER_HPP_
+#define MAPPEDTRAINER_HPP_
+
+#include <cstdint>
+
+#include "NetworkTrainer.hpp"
+#include "DatasetFile.hpp"
+
+namespace Neural {
+
+    // Binary data set read in place from its mapping, nothing is parsed nor loaded up front.
+    // Copies share the mapping, shuffling only reorders the indexes of the samples, the
+    // same way NetworkTrainer does so that both give the same passes.
+    class MappedTrainer : public INetworkTrainer {
+
+    public:
+        MappedTrainer(std::string const &filename);
+        ~MappedTrainer();
+        MappedTrainer(const MappedTrainer &trainer);
+        MappedTrainer &operator =(const MappedTrainer &trainer);
+
+        Topology const &getTopology() const;
+        std::unique_ptr<IReader> read() const;
+        size_t getSampleCount() const;
+        void shuffle(Random &random);
+        void setDebugFLag(bool mode);
+        bool getDebugFLag() const;
+
+    private:
+        class Reader;
+
+        bool _debug;
+        std::shared_ptr<const DatasetFile> _file;
+        Topology _topology;
+        std::vector<uint64_t> _order;    // empty until the first shuffle, the file order
+
+    };
+
+}
+
+#endif /*MAPPEDTRAINER_HPP_*/
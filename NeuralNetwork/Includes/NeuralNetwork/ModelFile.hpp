@@ -0,0 +1,132 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   20/05/2018 11:12:40
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 20/05/2018 19:38:02
+ */
+
+
+#ifndef MODELFILE_HPP_
+#define MODELFILE_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "NetworkException.hpp"
+#include "Topology.hpp"
+
+namespace Neural {
+
+    // Binary model, mapped in memory and read in place.
+    // [header 64 bytes][topology brief][block table][blocks]
+    // Every section starts on a 64 bytes boundary and every block is an array of doubles in the
+    // byte order of the writer, a dense layer block is row major [outputs][inputs + bias].
+    // Parameter blocks may be stored in a reduced precision, they are then decoded when read.
+    // The header holds a checksum of everything after it.
+    class ModelFile {
+
+    public: enum BlockKind {
+            DenseWeights = 1,     // index is the layer fed by the weights
+            DenseDeltas,
+            TransformWeights,     // index is the transform layer
+            TransformDeltas,
+            BatchNormState,       // [neurons][gamma, dgamma, beta, dbeta, mean, variance]
+            TrainingState,        // [epoch, position, dropout step, history stride, history skipped, seed] integers kept bit for bit
+            ErrorHistory
+        };
+
+    public: enum Precision {
+            Float64,
+            Float32,
+            Float16,
+            BFloat16
+        };
+
+    public: struct Block {
+            BlockKind kind;
+            unsigned index;
+            std::vector<double> values;
+        };
+
+    // Everything a model file holds, ANetworkData::snapshot fills it
+    public: struct Content {
+            Topology topology;
+            double error;
+            double recentAverageError;
+            double smoothing;
+            std::vector<Block> blocks;
+            Precision precision = Float64; // of the parameters, the training state and history stay in Float64
+        };
+
+    private:
+        struct Header {
+            char magic[8];
+            uint32_t version;
+            uint32_t byteOrder;
+            uint64_t fileSize;
+            uint64_t checksum;
+            uint32_t topologySize;
+            uint32_t blockCount;
+            double error;
+            double recentAverageError;
+            double smoothing;
+        };
+
+        struct TableEntry {
+            uint32_t kind;
+            uint32_t index;
+            uint64_t offset;
+            uint64_t count;
+            uint32_t precision;
+            uint32_t reserved;
+        };
+
+        // Version 1, every block in Float64
+        struct TableEntryV1 {
+            uint32_t kind;
+            uint32_t index;
+            uint64_t offset;
+            uint64_t count;
+        };
+
+    public:
+        static const uint32_t Version = 2;
+
+        // verify reads the whole file once to check its checksum
+        ModelFile(std::string const &path, bool verify = true);
+        ~ModelFile();
+        ModelFile(const ModelFile &file) = delete;
+        ModelFile &operator =(const ModelFile &file) = delete;
+
+        static void write(std::string const &path, Content const &content);
+        static bool isModelFile(std::string const &path);
+        static Precision parsePrecision(std::string const &name);
+
+        Topology getTopology() const;
+        double getError() const;
+        double getRecentAverageError() const;
+        double getSmoothing() const;
+        // nullptr when the file has no such block. Float64 blocks point into the mapping,
+        // the others are decoded into storage.
+        const double *getBlock(BlockKind kind, unsigned index, uint64_t &count, std::vector<double> &storage) const;
+
+    private:
+        std::string _path;
+        const unsigned char *_data;
+        size_t _size;
+        const Header *_header;
+        std::vector<TableEntry> _table;
+
+        static uint64_t align(uint64_t offset);
+        static uint64_t elementSize(uint32_t precision);
+        static void encode(std::vector<double> const &values, Precision precision, unsigned char *data);
+        static void decode(const unsigned char *data, Precision precision, uint64_t count, double *values);
+        static uint64_t checksum(uint64_t hash, const void *data, size_t size);
+
+    };
+
+}
+
+#endif /*MODELFILE_HPP_*/
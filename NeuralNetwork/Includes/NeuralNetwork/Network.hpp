@@ -20,9 +20,15 @@
 #include "NetworkTrainer.hpp"
 #include "ANetworkData.hpp"
 #include "Layer.hpp"
+#include "RecurrentLayer.hpp"
+#include "Workspace.hpp"
 
 namespace Neural {
 
+    class SnapshotPublisher;
+    class SampleStream;
+    class Checkpointer;
+
     class INetwork {
 
     public:
@@ -40,19 +46,81 @@ namespace Neural {
     class Network : public INetwork, public ANetworkData {
 
     public:
-        Network(const std::vector<unsigned> &topology, double recentAverageSmoothingFactor = 100);
+        Network(const Topology &topology, double recentAverageSmoothingFactor = 100, Initializer const &initializer = Initializer());
         ~Network();
         Network(const Network &network);
         Network &operator =(const Network &network);
 
+        // A pass interrupted by a checkpoint goes on from the position it stopped at
         void train(INetworkTrainer const &trainer);
+        // Online training until the stream ends, returns the number of trained samples.
+        // Records that do not fit the network are rejected on the stream.
+        unsigned long train(SampleStream &stream);
         void feedForward(const std::vector<double> &inputVals);
         std::vector<double> const getResults() const;
         void backProp(const std::vector<double> &targetVals);
 
+        // Inference that only reads the weights, the activations live in the caller workspace.
+        // Any number of threads may predict on the same network, each with its own workspace,
+        // as long as nothing trains it meanwhile. The result stays valid until the workspace is reused.
+        std::vector<double> const &predict(const std::vector<double> &inputVals, Workspace &workspace) const;
+
+        // One step of a sequence through a network starting with a recurrent layer
+        void streamForward(const std::vector<double> &frame);
+        void resetStream();
+
+        // Dropout is only applied between setTraining(true) and setTraining(false), train() does it
+        void setTraining(bool training);
+        bool isTraining() const;
+
+        // train() publishes a snapshot every interval samples and when it ends, nullptr stops it
+        void publishTo(SnapshotPublisher *publisher, unsigned interval = 1000);
+        // train() hands every sample to the checkpointer and saves once more when it ends, nullptr stops it
+        void checkpointTo(Checkpointer *checkpointer);
+        // Past limit points the error history keeps one point out of two, 0 keeps them all
+        void setHistoryLimit(unsigned limit);
+        std::vector<double> const &getErrorHistory() const;
+
+        // Besides the parameters, the model file holds the training progress, dropout step, seed and
+        // error history, so that training resumed from a checkpoint goes on bit for bit
+        using ANetworkData::loadFrom;
+        void loadFrom(const ModelFile &file);
+        void snapshot(ModelFile::Content &content) const;
+        // Passes completed by train(trainer) and samples already trained in the current one
+        unsigned long getEpoch() const;
+        unsigned long getPosition() const;
+        // Forgets the progress of a loaded checkpoint, the next train() starts a first pass
+        void restart();
+
         void errorPlot() const;
 
     private:
+        std::vector<double> _transformGradients;
+        std::vector<double> _logProbabilities; // softmax output only
+        bool _training;
+        SnapshotPublisher *_publisher;
+        unsigned _publishInterval;
+        Checkpointer *_checkpointer;
+        unsigned _historyLimit;
+        unsigned _historyStride;
+        unsigned _historySkipped;
+        uint64_t _dropoutStep;
+        uint64_t _epoch;
+        uint64_t _position;
+        std::vector<std::vector<double>> _dropoutMasks; // [layerNum][neuronNum] 0 or 1 / (1 - rate)
+
+        void trained(unsigned long trainingPass);
+        void trainingDone();
+        void recordError();
+
+        void softmax(Layer &outputLayer);
+        const std::vector<double> *dropout(unsigned layerNum); // draws the mask of the layer, nullptr without dropout
+
+        RecurrentLayer *getStream() const;
+        void forwardLayers(const std::vector<double> &values);
+
+        void backPropBatchNorm(unsigned layerNum);
+        void backPropTransforms();
         void showVectorVals(std::string const &label, std::vector<double> const &v) const;
 
     };
@@ -66,7 +134,7 @@ std::ostream &operator<<(std::ostream& os, const Neural::Network &network);
 namespace Neural {
 
     class INetwork;
-    class Network : public INetwork;
+    class Network;
 
 }
 
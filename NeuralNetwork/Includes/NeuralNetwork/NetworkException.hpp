@@ -52,6 +52,14 @@ namespace Neural {
 
     };
 
+    class CompilationError : public NetworkException {
+
+        public:
+            CompilationError(std::string const &message): NetworkException(message) {};
+            virtual ~CompilationError() throw() {};
+
+    };
+
 }
 
 #endif /*NETWORKEXCEPTION*/
@@ -0,0 +1,62 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   05/05/2018 15:42:10
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 05/05/2018 18:03:27
+ */
+
+
+#ifndef NETWORKPRUNER_HPP_
+#define NETWORKPRUNER_HPP_
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "NetworkException.hpp"
+#include "NetworkTrainer.hpp"
+#include "Network.hpp"
+
+namespace Neural {
+
+    class INetworkPruner {
+
+    public: struct NeuronStatistics {
+            double mean;
+            double variance;
+            double maxOutputWeight;
+        };
+
+    public:
+        virtual ~INetworkPruner() {};
+
+        virtual std::vector<std::vector<NeuronStatistics>> analyze(Network const &network, INetworkTrainer const &trainer) const = 0;
+        virtual unsigned prune(Network &network, INetworkTrainer const &trainer) const = 0;
+
+    };
+
+    class NetworkPruner : public INetworkPruner {
+
+    public:
+        NetworkPruner(double threshold = 1e-3);
+        ~NetworkPruner();
+        NetworkPruner(const NetworkPruner &pruner);
+        NetworkPruner &operator =(const NetworkPruner &pruner);
+
+        std::vector<std::vector<NeuronStatistics>> analyze(Network const &network, INetworkTrainer const &trainer) const;
+        unsigned prune(Network &network, INetworkTrainer const &trainer) const;
+
+        void setThreshold(double threshold);
+        double getThreshold() const;
+
+    private:
+        double _threshold; // neurons whose outgoing weights or output deviation stay under it are dead
+
+        bool isDead(NeuronStatistics const &stats) const;
+
+    };
+
+}
+
+#endif /*NETWORKPRUNER_HPP_*/
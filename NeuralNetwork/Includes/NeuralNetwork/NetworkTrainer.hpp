@@ -10,6 +10,7 @@
 #ifndef TRAININGDATA_HPP_
 #define TRAININGDATA_HPP_
 
+#include <memory>
 #include <vector>
 #include <string>
 #include <fstream>
@@ -17,6 +18,8 @@
 #include <iostream>
 
 #include "NetworkException.hpp"
+#include "Topology.hpp"
+#include "Random.hpp"
 
 namespace Neural {
 
@@ -27,37 +30,76 @@ public: struct TrainingData {
         std::vector<double> output;
     };
 
+// One pass over the samples
+public: class IReader {
+
+    public:
+        virtual ~IReader() {};
+
+        // nullptr once the pass is over, the sample stays valid until the next call
+        virtual const TrainingData *next() = 0;
+
+    };
+
 public:
-    ~INetworkTrainer() {};
+    virtual ~INetworkTrainer() {};
 
-    virtual std::vector<unsigned> const &getTopology() const = 0;
-    virtual std::vector<Neural::INetworkTrainer::TrainingData> const &getTrainingData() const = 0;
+    virtual Topology const &getTopology() const = 0;
+    // Starts a new pass, any number of them may be read at once
+    virtual std::unique_ptr<IReader> read() const = 0;
+    // Reorders the passes started afterwards
+    virtual void shuffle(Random &random) = 0;
     virtual void setDebugFLag(bool mode) = 0;
     virtual bool getDebugFLag() const = 0;
 
 };
 
+class DatasetParser;
+
+// The whole data set, loaded in memory.
+// Every value lives in one arena, a sample is its place in it, shuffling only moves the places.
+// Large files are cut in chunks at "in:" lines, parsed on the shared thread pool, then put end to end.
+// Once deduplicated, the identical samples are kept once with their count as weight: a pass then
+// draws as many samples as the file held, each one with a probability of its weight.
 class NetworkTrainer : public INetworkTrainer {
 
+private: struct Sample {
+        size_t offset;
+        unsigned inputs;
+        unsigned outputs;
+    };
+
 public:
     NetworkTrainer(const std::string filename);
     ~NetworkTrainer();
     NetworkTrainer(const NetworkTrainer &trainer);
     NetworkTrainer &operator =(const NetworkTrainer &trainer);
 
-    std::vector<unsigned> const &getTopology() const;
-    std::vector<Neural::INetworkTrainer::TrainingData> const &getTrainingData() const;
+    Topology const &getTopology() const;
+    std::unique_ptr<IReader> read() const;
+    size_t getSampleCount() const;
+    // Returns the number of distinct samples kept
+    size_t deduplicate();
+    size_t getUniqueCount() const;
+    void shuffle(Random &random);
     void setDebugFLag(bool mode);
     bool getDebugFLag() const;
 
 private:
-    bool _debug;
-    std::vector<unsigned> _topology;
-    std::vector<Neural::INetworkTrainer::TrainingData> _trainingData;
+    class Reader;
 
-    std::vector<unsigned> readTopology(std::ifstream &file) const;
-    std::vector<double> readNextInputs(std::ifstream &file) const;
-    std::vector<double> readTargetOutputs(std::ifstream &file) const;
+    static void load(DatasetParser &parser, size_t end, std::vector<double> &values, std::vector<Sample> &samples);
+
+    bool _debug;
+    Topology _topology;
+    std::vector<double> _values;    // inputs then outputs of every sample, in file order
+    std::vector<Sample> _samples;
+    // Deduplicated only: the count of every sample, and Vose's alias table to draw them by it
+    std::vector<uint64_t> _weights;
+    std::vector<double> _probabilities;
+    std::vector<unsigned> _aliases;
+    uint64_t _total;
+    uint64_t _drawSeed;
 
 };
 
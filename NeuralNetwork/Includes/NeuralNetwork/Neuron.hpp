@@ -50,15 +50,22 @@ namespace Neural {
 
         void setOutputVal(double val);
         double getOutputVal(void) const;
+        double getGradient(void) const;
+        void setGradient(double gradient);
+        double sumInputs(const Layer &prevLayer) const;
 
         void feedForward(const Neural::Layer &prevLayer);
+        void activate(double sum);
         void calcOutputGradients(double targetVal);
         void calcHiddenGradients(const Neural::Layer &nextLayer);
+        void calcHiddenGradients(const Neural::Layer &nextLayer, double dropoutScale);
         void updateInputWeights(Neural::Layer &prevLayer);
 
         void setConnection(unsigned index, Connection const &data);
         std::vector<Connection> const &getConnection() const;
         unsigned getConnectionCount() const;
+        void removeConnection(unsigned index);
+        void setIndex(unsigned index);
 
     private:
         double _eta;   // [0.0..1.0] overall net training rate
@@ -70,7 +77,6 @@ namespace Neural {
 
         double transferFunction(double x) const;
         double transferFunctionDerivative(double x) const;
-        double randomWeight(void) const;
         double sumDOW(const Neural::Layer &nextLayer) const;
 
     };
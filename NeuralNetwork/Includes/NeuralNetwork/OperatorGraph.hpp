@@ -0,0 +1,93 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   06/05/2018 14:20:51
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 06/05/2018 19:47:02
+ */
+
+
+#ifndef OPERATORGRAPH_HPP_
+#define OPERATORGRAPH_HPP_
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <algorithm>
+
+#include "NetworkException.hpp"
+#include "ANetworkData.hpp"
+
+namespace Neural {
+
+    class IOperatorGraph {
+
+    public: enum OperatorType {
+            Normalize,  // x * weights + bias, element wise
+            MatMul,     // weights[outputSize][inputSize] . x
+            BiasAdd,    // x + bias
+            Activation, // transfer(x)
+            Dense,      // transfer(weights . x + bias), fused in one pass
+            Softmax     // exp(x - max) / sum(exp(x - max))
+        };
+
+    public: enum TransferType {
+            Identity,
+            Tanh
+        };
+
+    public: struct Operator {
+            OperatorType type;
+            TransferType transfer;
+            unsigned inputSize;
+            unsigned outputSize;
+            std::vector<double> weights;
+            std::vector<double> bias;
+        };
+
+    public:
+        virtual ~IOperatorGraph() {};
+
+        virtual void fuse() = 0;
+        virtual void execute(const std::vector<double> &input, std::vector<double> &output, std::vector<double> &scratch) const = 0;
+        virtual void dump(std::ostream &os) const = 0;
+
+    };
+
+    class OperatorGraph : public IOperatorGraph {
+
+    public:
+        OperatorGraph(ANetworkData const &network);
+        OperatorGraph(ANetworkData const &network, std::vector<double> const &inputMean, std::vector<double> const &inputDeviation);
+        ~OperatorGraph();
+        OperatorGraph(const OperatorGraph &graph);
+        OperatorGraph &operator =(const OperatorGraph &graph);
+
+        void fuse();
+        void execute(const std::vector<double> &input, std::vector<double> &output, std::vector<double> &scratch) const;
+        // count samples stored one after the other, every weight row is read once for the whole batch
+        void executeBatch(const std::vector<double> &inputs, unsigned count, std::vector<double> &outputs, std::vector<double> &scratch) const;
+        void dump(std::ostream &os) const;
+
+        std::vector<Operator> const &getOperators() const;
+        unsigned getInputCount() const;
+        unsigned getOutputCount() const;
+        unsigned getMaxWidth() const;
+
+    private:
+        std::vector<Operator> _operators;
+
+        void lower(ANetworkData const &network);
+        void fuseDense();
+        void foldNormalize();
+        void run(Operator const &op, const double *input, double *output) const;
+        void runBatch(Operator const &op, const double *input, double *output, unsigned count) const;
+
+    };
+
+}
+
+std::ostream &operator<<(std::ostream& os, const Neural::OperatorGraph &graph);
+
+#endif /*OPERATORGRAPH_HPP_*/
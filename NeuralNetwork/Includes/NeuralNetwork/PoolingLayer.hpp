@@ -0,0 +1,44 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   10/05/2018 16:20:12
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 10/05/2018 18:52:58
+ */
+
+
+#ifndef POOLINGLAYER_HPP_
+#define POOLINGLAYER_HPP_
+
+#include "TransformLayer.hpp"
+
+namespace Neural {
+
+    // Max pooling over non overlapping size x size windows, per channel
+    class PoolingLayer : public ATransformLayer {
+
+    public:
+        PoolingLayer(Shape const &inputShape, unsigned size);
+        ~PoolingLayer();
+        PoolingLayer(const PoolingLayer &layer);
+        PoolingLayer &operator =(const PoolingLayer &layer);
+
+        static Shape outputShape(Shape const &inputShape, unsigned size);
+
+        std::string getDescription() const;
+        void feedForward(const std::vector<double> &input);
+        void backProp(const std::vector<double> &outputGradients);
+        void predict(const std::vector<double> &input, std::vector<double> &output, std::vector<double> &scratch) const;
+        ITransformLayer *clone() const;
+
+    private:
+        unsigned _size;
+        std::vector<unsigned> _selected; // input index of the maximum of every window
+
+        void pool(const double *input, double *output, unsigned *selected) const;
+
+    };
+
+}
+
+#endif /*POOLINGLAYER_HPP_*/
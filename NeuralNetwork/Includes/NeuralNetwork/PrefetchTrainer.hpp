@@ -0,0 +1,61 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   24/05/2018 09:52:14
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 24/05/2018 17:20:36
+ */
+
+
+#ifndef PREFETCHTRAINER_HPP_
+#define PREFETCHTRAINER_HPP_
+
+#include <cstdint>
+#include <mutex>
+
+#include "NetworkTrainer.hpp"
+
+namespace Neural {
+
+    // Reads the passes of another trainer on a thread of their own, in batches of samples:
+    // the next batch is read, parsed and shuffled while the network trains on the current one.
+    // At most depth batches exist at once, two is double buffering.
+    // The passes and their order are the ones of the other trainer, which must outlive this one.
+    class PrefetchTrainer : public INetworkTrainer {
+
+    public: struct Stats {
+            uint64_t batches = 0;
+            uint64_t stalls = 0;         // batches the training had to wait for
+            double stallSeconds = 0;
+            uint64_t loaderWaits = 0;    // times the loader had every batch full and waited for the training
+        };
+
+    public:
+        PrefetchTrainer(INetworkTrainer &source, unsigned batch = 1024, unsigned depth = 2);
+        ~PrefetchTrainer();
+        PrefetchTrainer(const PrefetchTrainer &trainer);
+        PrefetchTrainer &operator =(const PrefetchTrainer &trainer);
+
+        Topology const &getTopology() const;
+        std::unique_ptr<IReader> read() const;
+        void shuffle(Random &random);
+        void setDebugFLag(bool mode);
+        bool getDebugFLag() const;
+        // Of every pass read so far, the passes being read included
+        Stats getStats() const;
+
+    private:
+        class Reader;
+
+        bool _debug;
+        INetworkTrainer *_source;
+        unsigned _batch;
+        unsigned _depth;
+        mutable std::mutex _mutex;
+        mutable Stats _stats;
+
+    };
+
+}
+
+#endif /*PREFETCHTRAINER_HPP_*/
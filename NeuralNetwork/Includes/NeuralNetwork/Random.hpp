@@ -0,0 +1,55 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   14/05/2018 10:02:33
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 14/05/2018 17:48:12
+ */
+
+
+#ifndef RANDOM_HPP_
+#define RANDOM_HPP_
+
+#include <cstdint>
+#include <cmath>
+#include <array>
+
+namespace Neural {
+
+    // xoshiro256** generator, a (seed, stream) pair always gives the same sequence
+    // so that work split over threads stays reproducible whatever the split.
+    class Random {
+
+    public:
+        static const uint64_t DefaultSeed = 5489;
+
+    public:
+        Random(uint64_t seed = DefaultSeed, uint64_t stream = 0);
+        ~Random();
+        Random(const Random &random);
+        Random &operator =(const Random &random);
+
+        void seed(uint64_t seed, uint64_t stream = 0);
+        uint64_t next();
+        double uniform();                       // [0.0..1.0[
+        double uniform(double min, double max); // [min..max[
+        double normal();                        // mean 0, deviation 1
+        unsigned below(unsigned bound);         // [0..bound[
+
+        std::array<uint64_t, 4> const &getState() const;
+        void setState(std::array<uint64_t, 4> const &state);
+
+        // Counter based, hash(key) for consecutive keys are independent draws
+        static uint64_t hash(uint64_t key);
+
+    private:
+        std::array<uint64_t, 4> _state;
+
+        static uint64_t splitMix(uint64_t &x);
+        static uint64_t rotl(uint64_t x, int k);
+
+    };
+
+}
+
+#endif /*RANDOM_HPP_*/
@@ -0,0 +1,76 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   12/05/2018 10:14:45
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 12/05/2018 20:31:17
+ */
+
+
+#ifndef RECURRENTLAYER_HPP_
+#define RECURRENTLAYER_HPP_
+
+#include "TransformLayer.hpp"
+
+namespace Neural {
+
+    // LSTM or GRU over a sequence, the input shape is read as [steps][features] and
+    // the output is the last hidden state.
+    // LSTM gates are computed by one matrix product per step over [x, h, 1].
+    // GRU gates by one product over [x, 1] and one over [h, 1], the candidate needs r * (Uh + b).
+    // Training backpropagates through the last bptt steps only.
+    class RecurrentLayer : public ATransformLayer {
+
+    public: enum Cell {
+            LSTM,
+            GRU
+        };
+
+    public:
+        RecurrentLayer(Shape const &inputShape, Cell cell, unsigned hidden, Random &random, unsigned bptt = 0);
+        ~RecurrentLayer();
+        RecurrentLayer(const RecurrentLayer &layer);
+        RecurrentLayer &operator =(const RecurrentLayer &layer);
+
+        static Shape outputShape(Shape const &inputShape, unsigned hidden);
+
+        std::string getDescription() const;
+        void feedForward(const std::vector<double> &input);
+        void backProp(const std::vector<double> &outputGradients);
+        void predict(const std::vector<double> &input, std::vector<double> &output, std::vector<double> &scratch) const;
+        ITransformLayer *clone() const;
+
+        // Streaming inference, one step per call, the state is carried between calls
+        void step(const std::vector<double> &frame);
+        void resetState();
+        unsigned getFeatureCount() const;
+
+    private:
+        Cell _cell;
+        unsigned _hidden;
+        unsigned _bptt;
+        unsigned _steps;
+        unsigned _features;
+        unsigned _gates;
+        std::vector<double> _input;
+        std::vector<double> _activations; // [steps][gates * hidden] gates after their transfer function
+        std::vector<double> _recurrent;   // GRU only, [steps][hidden] U_n . h + b_hn
+        std::vector<double> _cells;       // LSTM only, [steps + 1][hidden] cell state
+        std::vector<double> _states;      // [steps + 1][hidden] hidden state
+        std::vector<double> _streamCell;
+        std::vector<double> _streamState;
+        std::vector<double> _streamGates;
+        std::vector<double> _streamRecurrent;
+        std::vector<double> _preactivation;
+        std::vector<double> _scratch;
+
+        void forwardStep(const double *x, const double *prevState, const double *prevCell, double *gates, double *recurrent, double *cell, double *state, double *inputSums, double *stateSums) const;
+        void backwardLSTM(unsigned from, const std::vector<double> &outputGradients, std::vector<double> &gradients);
+        void backwardGRU(unsigned from, const std::vector<double> &outputGradients, std::vector<double> &gradients);
+        double sigmoid(double x) const;
+
+    };
+
+}
+
+#endif /*RECURRENTLAYER_HPP_*/
@@ -0,0 +1,63 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   17/05/2018 18:21:05
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 18/05/2018 11:47:36
+ */
+
+
+#ifndef SAMPLESTREAM_HPP_
+#define SAMPLESTREAM_HPP_
+
+#include <string>
+#include <vector>
+
+#include "NetworkException.hpp"
+#include "NetworkTrainer.hpp"
+
+namespace Neural {
+
+    // Endless source of "in:" / "out:" records, read from a file descriptor (stdin by default)
+    // or from the clients of a unix socket, one after the other.
+    // Records are handed out as they arrive, nothing but the current line is kept.
+    // A "topology:" line may come first, it describes the network to create.
+    // Malformed records are skipped and counted instead of stopping the stream.
+    class SampleStream {
+
+    public:
+        SampleStream(int fd = 0);
+        SampleStream(std::string const &socketPath);
+        ~SampleStream();
+        SampleStream(const SampleStream &stream) = delete;
+        SampleStream &operator =(const SampleStream &stream) = delete;
+
+        // False once the descriptor is closed, a socket waits for the next client instead
+        bool next(INetworkTrainer::TrainingData &data);
+        // Waits for the "topology:" line, throws if a record comes first
+        Topology const &readTopology();
+        bool hasTopology() const;
+        void reject();
+        unsigned long getRejected() const;
+
+    private:
+        int _fd;
+        int _server;
+        std::string _socketPath;
+        std::vector<char> _buffer;
+        size_t _begin;
+        size_t _end;
+        bool _hasTopology;
+        Topology _topology;
+        std::vector<double> _pending; // inputs waiting for their "out:" line
+        unsigned long _rejected;
+
+        bool readLine(std::string &line);
+        bool fill();
+        static bool parse(std::string const &line, std::string &label, std::vector<double> &values);
+
+    };
+
+}
+
+#endif /*SAMPLESTREAM_HPP_*/
@@ -0,0 +1,79 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   16/05/2018 10:12:27
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 16/05/2018 19:33:45
+ */
+
+
+#ifndef SNAPSHOTPUBLISHER_HPP_
+#define SNAPSHOTPUBLISHER_HPP_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "OperatorGraph.hpp"
+
+namespace Neural {
+
+    // Immutable operator graph snapshots of a network being trained, served to other threads.
+    // Two slots are used in turn: readers pin the current slot with a counter and never block,
+    // the writer fills the other slot once its last reader left, then flips the current index.
+    // The snapshot replaced in that slot is released there, no reader can still see it.
+    class SnapshotPublisher {
+
+    private:
+        struct Slot {
+            std::shared_ptr<const OperatorGraph> graph;
+            std::atomic<unsigned> readers;
+            uint64_t version;
+        };
+
+    public: class Reader {
+
+        public:
+            Reader(Slot *slot);
+            ~Reader();
+            Reader(Reader &&reader);
+            Reader(const Reader &reader) = delete;
+            Reader &operator =(const Reader &reader) = delete;
+
+            OperatorGraph const &operator *() const;
+            OperatorGraph const *operator ->() const;
+            explicit operator bool() const;
+            uint64_t getVersion() const;
+
+        private:
+            Slot *_slot;
+
+        };
+
+    public:
+        SnapshotPublisher();
+        ~SnapshotPublisher();
+        SnapshotPublisher(const SnapshotPublisher &publisher) = delete;
+        SnapshotPublisher &operator =(const SnapshotPublisher &publisher) = delete;
+
+        // Writer side, the network is lowered and fused into a new snapshot
+        void publish(ANetworkData const &network);
+        void publish(std::shared_ptr<const OperatorGraph> const &graph);
+
+        // Reader side, lock free
+        Reader acquire() const;
+        void predict(const std::vector<double> &input, std::vector<double> &output, std::vector<double> &scratch) const;
+        uint64_t getVersion() const;
+
+    private:
+        mutable Slot _slots[2];
+        std::atomic<unsigned> _current;
+        std::mutex _writer;
+        uint64_t _version;
+
+    };
+
+}
+
+#endif /*SNAPSHOTPUBLISHER_HPP_*/
@@ -0,0 +1,51 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   21/05/2018 10:21:37
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 21/05/2018 17:48:05
+ */
+
+
+#ifndef STREAMINGTRAINER_HPP_
+#define STREAMINGTRAINER_HPP_
+
+#include <cstdint>
+
+#include "NetworkTrainer.hpp"
+
+namespace Neural {
+
+    // Data set read from disk at every pass, only the topology is loaded up front.
+    // A pass holds one sample at a time, or the window of samples it shuffles once shuffle()
+    // was called: a window of consecutive samples is read, shuffled, then handed out.
+    // The order of a pass only depends on the generator given to the last shuffle().
+    class StreamingTrainer : public INetworkTrainer {
+
+    public:
+        StreamingTrainer(std::string const &filename, unsigned window = 4096);
+        ~StreamingTrainer();
+        StreamingTrainer(const StreamingTrainer &trainer);
+        StreamingTrainer &operator =(const StreamingTrainer &trainer);
+
+        Topology const &getTopology() const;
+        std::unique_ptr<IReader> read() const;
+        void shuffle(Random &random);
+        void setDebugFLag(bool mode);
+        bool getDebugFLag() const;
+
+    private:
+        class Reader;
+
+        bool _debug;
+        std::string _filename;
+        Topology _topology;
+        unsigned _window;
+        bool _shuffle;
+        uint64_t _shuffleSeed;
+
+    };
+
+}
+
+#endif /*STREAMINGTRAINER_HPP_*/
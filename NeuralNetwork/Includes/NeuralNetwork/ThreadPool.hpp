@@ -0,0 +1,52 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   14/05/2018 13:51:06
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 14/05/2018 17:49:02
+ */
+
+
+#ifndef THREADPOOL_HPP_
+#define THREADPOOL_HPP_
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+
+namespace Neural {
+
+    class ThreadPool {
+
+    public:
+        ThreadPool(unsigned threads = 0); // 0 is one thread per core
+        ~ThreadPool();
+        ThreadPool(const ThreadPool &pool) = delete;
+        ThreadPool &operator =(const ThreadPool &pool) = delete;
+
+        std::future<void> submit(std::function<void()> const &task);
+        // Runs task(begin, end) over [0..count[ split in one range per thread, waits for all of them
+        void parallelFor(unsigned count, std::function<void(unsigned begin, unsigned end)> const &task);
+        unsigned getThreadCount() const;
+
+        // Pool shared by the library, created on first use
+        static ThreadPool &shared();
+
+    private:
+        std::vector<std::thread> _threads;
+        std::queue<std::packaged_task<void()>> _tasks;
+        std::mutex _mutex;
+        std::condition_variable _condition;
+        bool _stop;
+
+        void work();
+
+    };
+
+}
+
+#endif /*THREADPOOL_HPP_*/
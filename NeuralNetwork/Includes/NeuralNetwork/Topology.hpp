@@ -0,0 +1,82 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   10/05/2018 11:05:19
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 10/05/2018 18:53:06
+ */
+
+
+#ifndef TOPOLOGY_HPP_
+#define TOPOLOGY_HPP_
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <memory>
+
+#include "NetworkException.hpp"
+#include "TransformLayer.hpp"
+
+namespace Neural {
+
+    // Content of a "topology:" brief.
+    // "3 4 1" is a fully connected network, "1x8x8 conv:4:3 pool:2 8 1" starts with the
+    // input shape, then the transform layers, then the fully connected layers whose
+    // input size is deduced from the last transform output.
+    // "dropout:p" after a layer size drops that layer outputs with probability p while training.
+    // "batchnorm" after a layer size normalizes the sums of that layer before its transfer function.
+    // A trailing "softmax" replaces the tanh output layer and the RMS error by a softmax
+    // trained on the cross entropy.
+    class Topology {
+
+    public: enum Loss {
+            RMS,
+            SoftmaxCrossEntropy
+        };
+
+    public:
+        Topology();
+        Topology(std::vector<unsigned> const &layers, Loss loss = RMS);
+        Topology(std::string const &description);
+        Topology(Shape const &inputShape, std::vector<std::string> const &transforms, std::vector<unsigned> const &layers, Loss loss = RMS);
+        ~Topology();
+        Topology(const Topology &topology);
+        Topology &operator =(const Topology &topology);
+
+        std::vector<unsigned> const &getLayers() const;
+        std::vector<std::string> const &getTransforms() const;
+        Shape const &getInputShape() const;
+        unsigned getInputCount() const;
+        unsigned getOutputCount() const;
+        Loss getLoss() const;
+        std::vector<double> const &getDropout() const; // one rate per layer
+        void setDropout(std::vector<double> const &dropout);
+        std::vector<bool> const &getBatchNorm() const; // one flag per layer
+        void setBatchNorm(std::vector<bool> const &batchNorm);
+        std::string toString() const;
+
+        std::vector<std::unique_ptr<ITransformLayer>> createTransforms(Random &random) const;
+        static std::unique_ptr<ITransformLayer> createTransform(std::string const &description, Shape const &inputShape, Random &random);
+        // Output shape of a transform layer, without building it
+        static Shape transformShape(std::string const &description, Shape const &inputShape);
+
+    private:
+        Shape _inputShape;
+        std::vector<std::string> _transforms;
+        std::vector<unsigned> _layers;
+        std::vector<double> _dropout;
+        std::vector<bool> _batchNorm;
+        Loss _loss;
+
+        static bool isNumber(std::string const &token);
+        static bool isDropout(std::string const &token);
+        static double dropoutRate(std::string const &token);
+        static unsigned parameter(std::vector<std::string> const &fields, unsigned index);
+        static std::vector<std::string> transformFields(std::string const &description);
+
+    };
+
+}
+
+#endif /*TOPOLOGY_HPP_*/
@@ -0,0 +1,94 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   10/05/2018 10:31:08
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 10/05/2018 18:52:44
+ */
+
+
+#ifndef TRANSFORMLAYER_HPP_
+#define TRANSFORMLAYER_HPP_
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+#include "NetworkException.hpp"
+#include "Neuron.hpp"
+#include "Random.hpp"
+
+namespace Neural {
+
+    struct Shape {
+        unsigned channels;
+        unsigned height;
+        unsigned width;
+
+        unsigned size() const;
+        std::string toString() const;
+        static Shape parse(std::string const &description);
+    };
+
+    // Layers placed in front of the fully connected layers (convolution, pooling, ...),
+    // their output is latched into the input neurons of the network.
+    class ITransformLayer {
+
+    public:
+        virtual ~ITransformLayer() {};
+
+        virtual std::string getDescription() const = 0;
+        virtual Shape const &getInputShape() const = 0;
+        virtual Shape const &getOutputShape() const = 0;
+
+        virtual void feedForward(const std::vector<double> &input) = 0;
+        virtual std::vector<double> const &getOutput() const = 0;
+        virtual void backProp(const std::vector<double> &outputGradients) = 0;
+        virtual std::vector<double> const &getInputGradients() const = 0;
+        // Forward pass that leaves the layer untouched, for concurrent inference
+        virtual void predict(const std::vector<double> &input, std::vector<double> &output, std::vector<double> &scratch) const = 0;
+
+        virtual std::vector<INeuron::Connection> const &getParameters() const = 0;
+        virtual void setParameter(unsigned index, INeuron::Connection const &data) = 0;
+
+        virtual ITransformLayer *clone() const = 0;
+
+    };
+
+    class ATransformLayer : public ITransformLayer {
+
+    public:
+        ATransformLayer(Shape const &inputShape, Shape const &outputShape, double eta = 0.15, double alpha = 0.5);
+        virtual ~ATransformLayer();
+        ATransformLayer(const ATransformLayer &layer);
+        ATransformLayer &operator =(const ATransformLayer &layer);
+
+        Shape const &getInputShape() const;
+        Shape const &getOutputShape() const;
+        std::vector<double> const &getOutput() const;
+        std::vector<double> const &getInputGradients() const;
+
+        std::vector<INeuron::Connection> const &getParameters() const;
+        void setParameter(unsigned index, INeuron::Connection const &data);
+
+    protected:
+        Shape _inputShape;
+        Shape _outputShape;
+        double _eta;   // [0.0..1.0] overall net training rate
+        double _alpha; // [0.0..n] multiplier of last weight change (momentum)
+        std::vector<double> _output;
+        std::vector<double> _inputGradients;
+        std::vector<INeuron::Connection> _parameters;
+
+        void checkInput(const std::vector<double> &input) const;
+        void updateParameter(unsigned index, double gradient);
+        double randomWeight(Random &random, unsigned fanIn) const; // random is the generator of the network
+
+    };
+
+}
+
+#endif /*TRANSFORMLAYER_HPP_*/
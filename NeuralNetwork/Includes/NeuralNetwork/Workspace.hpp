@@ -0,0 +1,40 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   17/05/2018 09:48:13
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 17/05/2018 16:02:40
+ */
+
+
+#ifndef WORKSPACE_HPP_
+#define WORKSPACE_HPP_
+
+#include <vector>
+
+namespace Neural {
+
+    // Activation buffers of one Network::predict call, owned by the caller.
+    // Keep one per thread and reuse it, the buffers only grow so steady state calls do not allocate.
+    class Workspace {
+
+    public:
+        Workspace();
+        ~Workspace();
+        Workspace(const Workspace &workspace);
+        Workspace &operator =(const Workspace &workspace);
+
+        std::vector<double> &getBuffer(unsigned index); // two buffers used in turn between layers
+        std::vector<double> &getScratch();
+        std::vector<double> &getOutput();
+
+    private:
+        std::vector<double> _buffers[2];
+        std::vector<double> _scratch;
+        std::vector<double> _output;
+
+    };
+
+}
+
+#endif /*WORKSPACE_HPP_*/
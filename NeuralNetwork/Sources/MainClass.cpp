@@ -7,7 +7,13 @@
  */
 
 
+#include <cctype>
+#include <chrono>
+#include <functional>
+#include <set>
+
 #include "MainClass.h"
+#include "DatasetParser.hpp"
 
 MainClass::MainClass(int argc, char *argv[]): AMain(argc, argv, "MainClass") {
 
@@ -21,7 +27,34 @@ MainClass::~MainClass() {
 ArgParser::parser MainClass::setupArgParser() const {
     return ArgParser::parser {{
         { "help", {"-h", "--help"}, "Shows this help message.\n", 0},
-        { "dataset", {"-d", "--dataset"}, KRED + "[required]" + KNRM + " Specify the path to the data set.\n", 1}
+        { "dataset", {"-d", "--dataset"}, KRED + "[required]" + KNRM + " Specify the path to the data set.\n", 1},
+        { "load", {"-l", "--load"}, KRED + "[or]      " + KNRM + " Specify the path to a previously saved network.\n", 1},
+        { "save", {"-s", "--save"}, "            Specify a path where the trained network will be saved.\n", 1},
+        { "save_binary", {"-b", "--save-binary"}, "            Save the network in the binary model format, -l loads both formats.\n", 1},
+        { "export_weights", {"-w", "--export-weights"}, "            Save the weights only, for inference, in the binary model format at --precision.\n", 1},
+        { "precision", {"--precision"}, "            Precision of the exported weights: float64, float32, float16 or bfloat16, or of the converted data set: float64 or float32." + KYEL + "\n\tdefault: float32\n" + KNRM, 1},
+        { "prune", {"-p", "--prune"}, "            Remove the hidden neurons whose outgoing weights or output deviation are under the given threshold.\n", 1},
+        { "dump_graph", {"-g", "--dump-graph"}, "            Print the fused operator graph used for inference.\n", 0},
+        { "specialize", {"-S", "--specialize"}, "            Compile the trained network into a shared object cached in the given directory.\n", 1},
+        { "export_header", {"-e", "--export-header"}, "            Export the network as a standalone C++ header with constexpr weights.\n", 1},
+        { "seed", {"--seed"}, "            Seed of the weight initialization and of the shuffling." + KYEL + "\n\tdefault: 5489\n" + KNRM, 1},
+        { "init", {"--init"}, "            Weight initialization of a new network: uniform, xavier or he." + KYEL + "\n\tdefault: xavier\n" + KNRM, 1},
+        { "shuffle", {"--shuffle"}, "            Shuffle the data set before every pass.\n", 0},
+        { "streaming", {"--streaming"}, "            Read the data set from disk at every pass instead of loading it, with at most this many samples in memory, --shuffle shuffles within them.\n", 1},
+        { "dedup", {"--dedup"}, "            Keep the identical samples of the loaded data set once, weighted by their count: a pass draws its samples by weight.\n", 0},
+        { "prefetch", {"--prefetch"}, "            Read the data set on a thread of its own, this many samples ahead of the training, and print how often the training waited for them.\n", 1},
+        { "bench_parse", {"--bench-parse"}, "            Load the data set with the line stream loader and with the mapped parser, print the speed of both and exit.\n", 0},
+        { "convert", {"--convert"}, "            Write the data set in the binary data set format to this path, at --precision, and exit. -d reads both formats.\n", 1},
+        { "epochs", {"--epochs"}, "            Passes over the data set." + KYEL + "\n\tdefault: 1\n" + KNRM, 1},
+        { "stream", {"-i", "--stream"}, KRED + "[or]      " + KNRM + " Train online on the records read from stdin (-) or from the clients of a unix socket.\n", 1},
+        { "checkpoint", {"-c", "--checkpoint"}, "            Save the network being trained to this path in the background, in the binary model format.\n", 1},
+        { "checkpoint_every", {"--checkpoint-every"}, "            Samples between two checkpoints." + KYEL + "\n\tdefault: 10000\n" + KNRM, 1},
+        { "checkpoint_period", {"--checkpoint-period"}, "            Seconds between two checkpoints." + KYEL + "\n\tdefault: 60\n" + KNRM, 1},
+        { "resume", {"--resume"}, "            Go on with the training saved in the checkpoint when it exists, run the same command again to resume.\n", 0},
+        { "serve", {"--serve"}, "            Answer the requests of a unix socket (/path) or of a TCP port ([host:]port) with the network.\n", 1},
+        { "max_batch", {"--max-batch"}, "            Largest batch of requests run at once by the server." + KYEL + "\n\tdefault: 32\n" + KNRM, 1},
+        { "max_latency", {"--max-latency"}, "            Microseconds a request may wait for its batch to fill." + KYEL + "\n\tdefault: 1000\n" + KNRM, 1},
+        { "threads", {"--threads"}, "            Worker threads of the server, 0 is one per core." + KYEL + "\n\tdefault: 0\n" + KNRM, 1}
     }};
 }
 
@@ -30,30 +63,241 @@ bool MainClass::Run(ArgParser::parser_results const &args) {
     if (!this->checkArgument(args)) {
         return false;
     }
+    if (args["bench_parse"] && args["dataset"]) {
+        this->benchParse(args["dataset"].as<std::string>());
+        return true;
+    }
+    if (args["convert"] && args["dataset"]) {
+        this->convertDataset(args["dataset"].as<std::string>(), args["convert"].as<std::string>(), Neural::DatasetFile::parsePrecision(args["precision"].as<std::string>("float32")));
+        return true;
+    }
 
-    Neural::NetworkTrainer trainer(args["dataset"].as<std::string>());
-    Neural::Network network(trainer.getTopology());
+    Neural::Network network(std::vector<unsigned> {});
+    if (args["load"]) {
+        network.loadFrom(args["load"].as<std::string>());
+        network.restart();
+    }
+
+    uint64_t seed = args["seed"].as<unsigned long long>(Neural::Random::DefaultSeed);
+    Neural::Initializer initializer(Neural::Initializer::parse(args["init"].as<std::string>("xavier")), seed);
+    std::unique_ptr<Neural::Checkpointer> checkpointer;
+    if (args["checkpoint"]) {
+        std::string path = args["checkpoint"].as<std::string>();
+        if (args["resume"] && Neural::ModelFile::isModelFile(path)) {
+            network.loadFrom(path);
+            this->logger.info() << "Resuming from " << path;
+            if (args["dataset"])
+                this->logger.info() << "Pass " << network.getEpoch() + 1 << " goes on from its sample " << network.getPosition();
+        }
+        checkpointer.reset(new Neural::Checkpointer(path, args["checkpoint_every"].as<unsigned long>(10000), args["checkpoint_period"].as<double>(60.0)));
+    }
 
-    network.train(trainer);
+    if (args["dataset"]) {
+        std::string path = args["dataset"].as<std::string>();
+        std::unique_ptr<Neural::INetworkTrainer> source;
+        if (Neural::DatasetFile::isDatasetFile(path))
+            source.reset(new Neural::MappedTrainer(path));
+        else if (args["streaming"])
+            source.reset(new Neural::StreamingTrainer(path, args["streaming"].as<unsigned>()));
+        else {
+            Neural::NetworkTrainer *loaded = new Neural::NetworkTrainer(path);
+            source.reset(loaded);
+            if (args["dedup"]) {
+                size_t samples = loaded->getSampleCount();
+                this->logger.info() << "Deduplication kept " << loaded->deduplicate() << " distinct samples of " << samples;
+            }
+        }
+        std::unique_ptr<Neural::PrefetchTrainer> prefetch;
+        if (args["prefetch"])
+            prefetch.reset(new Neural::PrefetchTrainer(*source, args["prefetch"].as<unsigned>()));
+        Neural::INetworkTrainer &trainer = prefetch ? *prefetch : *source;
+        if (network.getLayerCount() == 0) {
+            network = Neural::Network(trainer.getTopology(), 100, initializer);
+        }
+        // Attached once the network is built, an assigned network does not keep its checkpointer
+        network.checkpointTo(checkpointer.get());
+        // Every pass shuffles the order of the previous one, a resumed run replays the shuffles of its done passes
+        unsigned long epochs = args["epochs"].as<unsigned long>(1);
+        for (unsigned long epoch = 0; epoch < epochs; ++epoch) {
+            if (args["shuffle"]) {
+                Neural::Random random(seed, epoch);
+                trainer.shuffle(random);
+            }
+            if (epoch >= network.getEpoch())
+                network.train(trainer);
+        }
+        if (prefetch) {
+            Neural::PrefetchTrainer::Stats stats = prefetch->getStats();
+            this->logger.info() << "Prefetching: the training waited for " << stats.stalls << " of " << stats.batches << " batches, " << stats.stallSeconds << " s in all, the loader waited " << stats.loaderWaits << " times for the training";
+        }
+        if (args["prune"]) {
+            Neural::NetworkPruner pruner(args["prune"].as<double>(0.001));
+            unsigned removed = pruner.prune(network, trainer);
+            this->logger.info() << "Pruning removed " << removed << " dead neuron" << (removed > 1 ? "s" : "");
+        }
+    }
+
+    if (args["stream"]) {
+        this->trainStream(args, network, initializer, checkpointer.get());
+    }
+    network.checkpointTo(nullptr);
     std::cout << network;
-    //network.saveTo("./samples_save/or_gate.txt");
 
-    //Neural::Network network2(std::vector<unsigned> {});
-    //network2.loadFrom("./samples_save/or_gate.txt");
+    this->exportNetwork(args, network);
+
+    if (args["dataset"]) {
+        network.errorPlot();
+    }
 
-    network.errorPlot();
+    if (args["serve"]) {
+        Neural::InferenceServer::Options options(args["max_batch"].as<unsigned>(32), args["max_latency"].as<unsigned>(1000), args["threads"].as<unsigned>(0));
+        Neural::InferenceServer server(network, options);
+        server.listen(args["serve"].as<std::string>());
+        this->logger.info() << "Serving on " << server.getAddress();
+        server.run();
+    }
 
     return true;
 }
 
+void MainClass::trainStream(ArgParser::parser_results const &args, Neural::Network &network, Neural::Initializer const &initializer, Neural::Checkpointer *checkpointer) const {
+    std::string source = args["stream"].as<std::string>();
+    std::unique_ptr<Neural::SampleStream> stream(source == "-" ? new Neural::SampleStream() : new Neural::SampleStream(source));
+
+    if (network.getLayerCount() == 0) {
+        network = Neural::Network(stream->readTopology(), 100, initializer);
+    }
+    network.checkpointTo(checkpointer);
+    // The stream may never end, the error history must not grow with it
+    network.setHistoryLimit(100000);
+    unsigned long trained = network.train(*stream);
+    this->logger.info() << "Trained on " << trained << " streamed sample" << (trained > 1 ? "s" : "") << ", " << stream->getRejected() << " rejected, " << network.getErrorHistory().size() << " error history points kept";
+}
+
+void MainClass::exportNetwork(ArgParser::parser_results const &args, Neural::Network const &network) const {
+    if (args["dump_graph"]) {
+        Neural::GraphNetwork engine(network);
+        engine.dump(std::cout);
+    }
+    if (args["specialize"]) {
+        Neural::CompiledNetwork compiled(network, args["specialize"].as<std::string>());
+        this->logger.info() << "Specialized network " << (compiled.isFromCache() ? "loaded from " : "compiled to ") << compiled.getLibraryPath();
+    }
+    if (args["export_header"]) {
+        std::string path = args["export_header"].as<std::string>();
+        std::ofstream file(path.c_str());
+        if (!file)
+            throw Neural::InvalidSavingFile("The header " + path + " could not be created");
+        file << Neural::CodeGenerator(Neural::OperatorGraph(network)).generateHeader(MainClass::headerNamespace(path));
+        this->logger.info() << "Network exported to " << path;
+    }
+    if (args["save"]) {
+        network.saveTo(args["save"].as<std::string>());
+    }
+    if (args["save_binary"]) {
+        network.saveBinary(args["save_binary"].as<std::string>());
+    }
+    if (args["export_weights"]) {
+        network.exportWeights(args["export_weights"].as<std::string>(), Neural::ModelFile::parsePrecision(args["precision"].as<std::string>("float32")));
+    }
+}
+
+void MainClass::benchParse(std::string const &path) const {
+    // The loader of the first versions: one string, one stringstream and two vectors per sample
+    auto streamLoader = [&path]() {
+        std::vector<Neural::INetworkTrainer::TrainingData> samples;
+        std::ifstream file(path.c_str());
+        std::string line;
+        std::string label;
+        getline(file, line);
+        while (!file.eof()) {
+            Neural::INetworkTrainer::TrainingData data;
+            for (auto *values: {&data.input, &data.output}) {
+                getline(file, line);
+                std::stringstream ss(line);
+                double value;
+                ss >> label;
+                while (ss >> value) {
+                    values->push_back(value);
+                }
+            }
+            if (data.input.empty() || data.output.empty())
+                break;
+            samples.push_back(data);
+        }
+        return samples.size();
+    };
+    auto mappedParser = [&path]() {
+        return Neural::NetworkTrainer(path).getSampleCount();
+    };
+
+    std::ifstream file(path.c_str(), std::ios::binary | std::ios::ate);
+    double megabytes = file.tellg() / 1e6;
+    for (auto const &loader: {std::make_pair(std::string("line stream loader"), std::function<size_t()>(streamLoader)), std::make_pair("mapped parser, " + std::to_string(Neural::ThreadPool::shared().getThreadCount()) + " threads", std::function<size_t()>(mappedParser))}) {
+        auto start = std::chrono::steady_clock::now();
+        size_t samples = loader.second();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        this->logger.info() << loader.first << ": " << samples << " samples in " << seconds << " s, " << megabytes / seconds << " MB/s";
+    }
+}
+
+void MainClass::convertDataset(std::string const &from, std::string const &to, Neural::DatasetFile::Precision precision) const {
+    Neural::DatasetParser parser(from);
+    Neural::DatasetFile::Writer writer(to, parser.getTopology().toString(), precision);
+    std::vector<double> input;
+    std::vector<double> output;
+
+    while (parser.next(input, output)) {
+        writer.add(input, output);
+    }
+    writer.close();
+    this->logger.info() << "Converted " << writer.getSampleCount() << " samples of " << from << " to " << to;
+}
+
+std::string MainClass::headerNamespace(std::string const &path) {
+    std::string name = path.substr(path.find_last_of('/') + 1);
+    name = name.substr(0, name.find('.'));
+    static const std::set<std::string> keywords = {
+        "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break", "case", "catch",
+        "char", "char16_t", "char32_t", "class", "compl", "const", "const_cast", "constexpr", "continue", "decltype",
+        "default", "delete", "do", "double", "dynamic_cast", "else", "enum", "explicit", "export", "extern", "false",
+        "float", "for", "friend", "goto", "if", "inline", "int", "long", "mutable", "namespace", "new", "noexcept",
+        "not", "not_eq", "nullptr", "operator", "or", "or_eq", "private", "protected", "public", "register",
+        "reinterpret_cast", "return", "short", "signed", "sizeof", "static", "static_assert", "static_cast", "struct",
+        "switch", "template", "this", "thread_local", "throw", "true", "try", "typedef", "typeid", "typename", "union",
+        "unsigned", "using", "virtual", "void", "volatile", "wchar_t", "while", "xor", "xor_eq"
+    };
+    for (auto &c: name) {
+        if (!isalnum(static_cast<unsigned char>(c)))
+            c = '_';
+    }
+    return name.empty() || isdigit(static_cast<unsigned char>(name[0])) || keywords.count(name) ? "model_" + name : name;
+}
+
 bool MainClass::checkArgument(ArgParser::parser_results const &args) const {
     if (args["help"]) {
         ArgParser::fmt_ostream(std::cerr) << "Usage:" << std::endl << this->setupArgParser();
         return false;
     }
 
-    if (!args["dataset"]) {
-        ArgParser::fmt_ostream(std::cerr) << KRED + "\nYou must provide a path to a data set using -d or --dataset\n" + KNRM << std::endl << this->setupArgParser();
+    if (!args["dataset"] && !args["load"] && !args["stream"]) {
+        ArgParser::fmt_ostream(std::cerr) << KRED + "\nYou must provide a path to a data set using -d or --dataset, to a saved network using -l or --load, or a stream using -i or --stream\n" + KNRM << std::endl << this->setupArgParser();
+        return false;
+    }
+
+    // A binary data set is read in place from its mapping, it is neither streamed nor loaded
+    if (args["dataset"] && (args["streaming"] || args["dedup"]) && Neural::DatasetFile::isDatasetFile(args["dataset"].as<std::string>())) {
+        ArgParser::fmt_ostream(std::cerr) << KRED + "\nYou cannot use --streaming or --dedup with a binary data set, it is read from its mapping\n" + KNRM << std::endl << this->setupArgParser();
+        return false;
+    }
+
+    if (args["dedup"] && args["streaming"]) {
+        ArgParser::fmt_ostream(std::cerr) << KRED + "\nYou cannot deduplicate a data set read from disk using --streaming\n" + KNRM << std::endl << this->setupArgParser();
+        return false;
+    }
+
+    if (args["resume"] && !args["checkpoint"]) {
+        ArgParser::fmt_ostream(std::cerr) << KRED + "\nYou must provide the checkpoint to resume from using -c or --checkpoint\n" + KNRM << std::endl << this->setupArgParser();
         return false;
     }
 
@@ -7,11 +7,29 @@
  */
 
 
+#include <algorithm>
+
 #include "ANetworkData.hpp"
 
-Neural::ANetworkData::ANetworkData(const std::vector<unsigned> &topology, double recentAverageSmoothingFactor) {
+Neural::ANetworkData::ANetworkData(const Topology &description, double recentAverageSmoothingFactor, Initializer const &initializer) {
+    this->build(description, recentAverageSmoothingFactor, initializer.getSeed());
+    this->initialize(initializer);
+}
+
+void Neural::ANetworkData::build(const Topology &description, double recentAverageSmoothingFactor, uint64_t seed) {
+    std::vector<unsigned> const &topology = description.getLayers();
+    this->_error = 0;
     this->_recentAverageError = 1;
     this->_recentAverageSmoothingFactor = recentAverageSmoothingFactor;
+    this->_errorHistory.clear();
+    // Transform layers draw their weights from stream 0 of the seed, the neurons use the others
+    this->_random.seed(seed, 0);
+    this->_transforms = description.createTransforms(this->_random);
+    this->_loss = description.getLoss();
+    this->_dropout = description.getDropout();
+    this->_seed = seed;
+    this->_layers.clear();
+    this->_batchNorms.clear();
     unsigned numLayers = topology.size();
     for (unsigned layerNum = 0; layerNum < numLayers; ++layerNum) {
         this->_layers.emplace_back();
@@ -22,7 +40,31 @@ Neural::ANetworkData::ANetworkData(const std::vector<unsigned> &topology, double
             this->_layers.back().push_back(Neuron(numOutputs, neuronNum));
         }
         this->_layers.back().back().setOutputVal(1.0); //bias neuron
+        this->_batchNorms.emplace_back(description.getBatchNorm()[layerNum] ? topology[layerNum] : 0);
+    }
+}
+
+void Neural::ANetworkData::initialize(Initializer const &initializer) {
+    // One stream per neuron, the weights do not depend on how the neurons are split over threads
+    std::vector<std::pair<unsigned, unsigned>> neurons;
+    for (unsigned layerNum = 0; layerNum + 1 < this->_layers.size(); ++layerNum) {
+        for (unsigned n = 0; n < this->_layers[layerNum].size(); ++n) {
+            neurons.emplace_back(layerNum, n);
+        }
     }
+    ThreadPool::shared().parallelFor(neurons.size(), [this, &neurons, &initializer](unsigned begin, unsigned end) {
+        for (unsigned i = begin; i < end; ++i) {
+            Layer &layer = this->_layers[neurons[i].first];
+            Neuron &neuron = layer[neurons[i].second];
+            Random random(initializer.getSeed(), ((uint64_t)neurons[i].first << 32 | neurons[i].second) + 1);
+            bool bias = neurons[i].second == layer.size() - 1;
+            unsigned fanOut = this->_layers[neurons[i].first + 1].size() - 1;
+            for (unsigned c = 0; c < neuron.getConnectionCount(); ++c) {
+                double weight = bias ? initializer.bias(random) : initializer.weight(random, layer.size() - 1, fanOut);
+                neuron.setConnection(c, Neural::INeuron::Connection{weight, 0.0});
+            }
+        }
+    });
 }
 
 Neural::ANetworkData::~ANetworkData() {
@@ -39,31 +81,56 @@ Neural::ANetworkData &Neural::ANetworkData::operator =(const ANetworkData &data)
 }
 
 void Neural::ANetworkData::loadFrom(const ANetworkData &data) {
+    this->_transforms.clear();
+    for (auto const &transform: data._transforms) {
+        this->_transforms.emplace_back(transform->clone());
+    }
     this->_layers = data._layers;
+    this->_loss = data._loss;
+    this->_dropout = data._dropout;
+    this->_batchNorms = data._batchNorms;
+    this->_seed = data._seed;
+    this->_random = data._random;
     this->_error = data._error;
+    this->_errorHistory = data._errorHistory;
     this->_recentAverageError = data._recentAverageError;
     this->_recentAverageSmoothingFactor = data._recentAverageSmoothingFactor;
 }
 
 void Neural::ANetworkData::loadFrom(const std::string &filepath) {
+    if (ModelFile::isModelFile(filepath)) {
+        this->loadFrom(ModelFile(filepath));
+        return;
+    }
+
     std::ifstream file;
     file.open(filepath.c_str());
     if (file) {
-        std::vector<unsigned>topology = readTopology(file);
+        Topology topology = readTopology(file);
         std::vector<double>error = readError(file);
         if (error.size() != 3)
             throw Neural::InvalidSavingFile("Your saving file " + filepath + " contains incorrect error information");
-        ANetworkData newData(topology, error[2]);
-        newData._error = error[0];
-        newData._recentAverageError = error[1];
-        *this = newData;
-        while (!file.eof()) {
+        this->build(topology, error[2], Random::DefaultSeed);
+        this->_error = error[0];
+        this->_recentAverageError = error[1];
+        std::string line;
+        while (getline(file, line)) {
             std::vector<unsigned> coord;
             Neural::INeuron::Connection data{};
-            readNextNeuron(file, coord, data);
+            if (line.compare(0, 2, "b ") == 0) {
+                this->readBatchNorm(line.substr(2), filepath);
+                continue;
+            }
+            bool transform = line.compare(0, 2, "t ") == 0;
+            readNextNeuron(transform ? line.substr(2) : line, coord, data);
             if (coord.empty())
                 break;
-            this->_layers[coord[0]][coord[1]].setConnection(coord[2], data);
+            if (transform && coord[0] < this->_transforms.size())
+                this->_transforms[coord[0]]->setParameter(coord[1], data);
+            else if (!transform && coord[0] < this->_layers.size() && coord[1] < this->_layers[coord[0]].size() && coord[2] < this->_layers[coord[0]][coord[1]].getConnectionCount())
+                this->_layers[coord[0]][coord[1]].setConnection(coord[2], data);
+            else
+                throw Neural::InvalidSavingFile("Your saving file " + filepath + " references a connection that does not exist in its topology");
         }
 
         file.close();
@@ -72,18 +139,176 @@ void Neural::ANetworkData::loadFrom(const std::string &filepath) {
     }
 }
 
+void Neural::ANetworkData::loadFrom(const ModelFile &file) {
+    uint64_t count;
+    std::vector<double> weightStorage;
+    std::vector<double> deltaStorage;
+
+    this->build(file.getTopology(), file.getSmoothing(), Random::DefaultSeed);
+    this->_error = file.getError();
+    this->_recentAverageError = file.getRecentAverageError();
+
+    // Blocks are copied as they are, the deltas are optional
+    for (unsigned t = 0; t < this->_transforms.size(); ++t) {
+        unsigned size = this->_transforms[t]->getParameters().size();
+        const double *weights = file.getBlock(ModelFile::TransformWeights, t, count, weightStorage);
+        if (weights == nullptr || count != size)
+            throw Neural::InvalidSavingFile("Your model file does not hold the " + std::to_string(size) + " parameters of " + this->_transforms[t]->getDescription());
+        const double *deltas = file.getBlock(ModelFile::TransformDeltas, t, count, deltaStorage);
+        if (count != size)
+            deltas = nullptr;
+        for (unsigned p = 0; p < size; ++p) {
+            this->_transforms[t]->setParameter(p, Neural::INeuron::Connection{weights[p], deltas ? deltas[p] : 0.0});
+        }
+    }
+
+    for (unsigned layerNum = 1; layerNum < this->_layers.size(); ++layerNum) {
+        Layer &prevLayer = this->_layers[layerNum - 1];
+        unsigned outputs = this->_layers[layerNum].size() - 1;
+        unsigned inputs = prevLayer.size();
+        const double *weights = file.getBlock(ModelFile::DenseWeights, layerNum, count, weightStorage);
+        if (weights == nullptr || count != (uint64_t)outputs * inputs)
+            throw Neural::InvalidSavingFile("Your model file does not hold the " + std::to_string(outputs * inputs) + " weights of the layer " + std::to_string(layerNum));
+        const double *deltas = file.getBlock(ModelFile::DenseDeltas, layerNum, count, deltaStorage);
+        if (count != (uint64_t)outputs * inputs)
+            deltas = nullptr;
+        for (unsigned o = 0; o < outputs; ++o) {
+            for (unsigned i = 0; i < inputs; ++i) {
+                unsigned n = o * inputs + i;
+                prevLayer[i].setConnection(o, Neural::INeuron::Connection{weights[n], deltas ? deltas[n] : 0.0});
+            }
+        }
+
+        std::vector<BatchNorm> &batchNorms = this->_batchNorms[layerNum];
+        if (batchNorms.empty())
+            continue;
+        const double *state = file.getBlock(ModelFile::BatchNormState, layerNum, count, weightStorage);
+        if (state == nullptr || count != batchNorms.size() * 6)
+            throw Neural::InvalidSavingFile("Your model file does not hold the batch normalization of the layer " + std::to_string(layerNum));
+        for (unsigned n = 0; n < batchNorms.size(); ++n, state += 6) {
+            batchNorms[n].setState(Neural::INeuron::Connection{state[0], state[1]}, Neural::INeuron::Connection{state[2], state[3]}, state[4], state[5]);
+        }
+    }
+}
+
+void Neural::ANetworkData::saveBinary(const std::string &filepath) const {
+    ModelFile::Content content;
+
+    this->snapshot(content);
+    ModelFile::write(filepath, content);
+}
+
+void Neural::ANetworkData::exportWeights(const std::string &filepath, ModelFile::Precision precision) const {
+    ModelFile::Content content;
+
+    // Batch norm is folded into the weights of a copy, the inference only runs the dense layers
+    bool batchNorm = std::any_of(this->_batchNorms.begin(), this->_batchNorms.end(), [](std::vector<BatchNorm> const &layer) {
+        return !layer.empty();
+    });
+    if (batchNorm) {
+        ANetworkData folded(*this);
+        folded.foldBatchNorm();
+        folded.snapshot(content);
+    } else {
+        this->snapshot(content);
+    }
+    std::vector<ModelFile::Block> &blocks = content.blocks;
+    blocks.erase(std::remove_if(blocks.begin(), blocks.end(), [](ModelFile::Block const &block) {
+        return block.kind != ModelFile::DenseWeights && block.kind != ModelFile::TransformWeights;
+    }), blocks.end());
+    content.precision = precision;
+    ModelFile::write(filepath, content);
+}
+
+void Neural::ANetworkData::snapshot(ModelFile::Content &content) const {
+    std::vector<ModelFile::Block> &blocks = content.blocks;
+    unsigned count = 0;
+    // Blocks are handed out by reference, they must not move while the snapshot is taken
+    blocks.reserve(2 * this->_transforms.size() + 3 * this->_layers.size());
+    auto next = [&blocks, &count](ModelFile::BlockKind kind, unsigned index, size_t size) -> std::vector<double> & {
+        if (count == blocks.size())
+            blocks.emplace_back();
+        ModelFile::Block &block = blocks[count++];
+        block.kind = kind;
+        block.index = index;
+        block.values.resize(size);
+        return block.values;
+    };
+
+    content.topology = this->getTopology();
+    content.error = this->_error;
+    content.recentAverageError = this->_recentAverageError;
+    content.smoothing = this->_recentAverageSmoothingFactor;
+
+    for (unsigned t = 0; t < this->_transforms.size(); ++t) {
+        std::vector<Neural::INeuron::Connection> const &parameters = this->_transforms[t]->getParameters();
+        std::vector<double> &weights = next(ModelFile::TransformWeights, t, parameters.size());
+        std::vector<double> &deltas = next(ModelFile::TransformDeltas, t, parameters.size());
+        for (unsigned p = 0; p < parameters.size(); ++p) {
+            weights[p] = parameters[p].weight;
+            deltas[p] = parameters[p].deltaWeight;
+        }
+    }
+
+    // Row major [outputs][inputs + bias], the layout the inference reads
+    for (unsigned layerNum = 1; layerNum < this->_layers.size(); ++layerNum) {
+        Layer const &prevLayer = this->_layers[layerNum - 1];
+        unsigned outputs = this->_layers[layerNum].size() - 1;
+        unsigned inputs = prevLayer.size();
+        std::vector<double> &weights = next(ModelFile::DenseWeights, layerNum, outputs * inputs);
+        std::vector<double> &deltas = next(ModelFile::DenseDeltas, layerNum, outputs * inputs);
+        // The neurons hold columns, 16 rows at a time keeps the written lines in cache
+        for (unsigned first = 0; first < outputs; first += 16) {
+            unsigned last = std::min(outputs, first + 16);
+            for (unsigned i = 0; i < inputs; ++i) {
+                const Neural::INeuron::Connection *connections = prevLayer[i].getConnection().data();
+                for (unsigned o = first; o < last; ++o) {
+                    weights[o * inputs + i] = connections[o].weight;
+                    deltas[o * inputs + i] = connections[o].deltaWeight;
+                }
+            }
+        }
+
+        std::vector<BatchNorm> const &batchNorms = this->_batchNorms[layerNum];
+        if (batchNorms.empty())
+            continue;
+        double *state = next(ModelFile::BatchNormState, layerNum, batchNorms.size() * 6).data();
+        for (auto const &batchNorm: batchNorms) {
+            *state++ = batchNorm.getGamma().weight;
+            *state++ = batchNorm.getGamma().deltaWeight;
+            *state++ = batchNorm.getBeta().weight;
+            *state++ = batchNorm.getBeta().deltaWeight;
+            *state++ = batchNorm.getMean();
+            *state++ = batchNorm.getVariance();
+        }
+    }
+    blocks.resize(count);
+}
+
 void Neural::ANetworkData::saveTo(const std::string &filepath) const {
     std::ofstream       file;
     file.open(filepath.c_str());
     if (!file)
         throw Neural::InvalidSavingFile("The file in which you are trying to save could not be created..");
-    file << "topology:";
-    for (auto const& layer: this->_layers) {
-        file << " " << layer.size() - 1;
-    }
-    file << std::endl;
+    file << "topology: " << this->getTopology().toString() << std::endl;
     file << "error: " << this->_error << " " << this->_recentAverageError << " " << this->_recentAverageSmoothingFactor << std::endl;
 
+    for (unsigned t = 0; t < this->_transforms.size(); ++t) {
+        unsigned p = 0;
+        for (auto const &parameter: this->_transforms[t]->getParameters()) {
+            file << "t " << t << " " << p << " 0 " << parameter.weight << " " << parameter.deltaWeight << std::endl;
+            p++;
+        }
+    }
+
+    for (unsigned l = 0; l < this->_batchNorms.size(); ++l) {
+        unsigned n = 0;
+        for (auto const &batchNorm: this->_batchNorms[l]) {
+            file << "b " << l << " " << n << " " << batchNorm.getGamma().weight << " " << batchNorm.getGamma().deltaWeight << " " << batchNorm.getBeta().weight << " " << batchNorm.getBeta().deltaWeight << " " << batchNorm.getMean() << " " << batchNorm.getVariance() << std::endl;
+            n++;
+        }
+    }
+
     unsigned i = 0;
     for (auto const& layer: this->_layers) {
         if (i == this->_layers.size() - 1)
@@ -103,8 +328,55 @@ void Neural::ANetworkData::saveTo(const std::string &filepath) const {
     file.close();
 }
 
-std::vector<unsigned> Neural::ANetworkData::readTopology(std::ifstream &file) const {
-    std::vector<unsigned> topology;
+void Neural::ANetworkData::removeNeuron(unsigned layerNum, unsigned neuronNum, double constantOutput) {
+    if (layerNum == 0 || layerNum >= this->_layers.size() - 1)
+        throw Neural::InvalidInput("Only hidden layer neurons can be removed from the network");
+    Layer &layer = this->_layers[layerNum];
+    if (neuronNum >= layer.size() - 1)
+        throw Neural::InvalidInput("Neuron " + std::to_string(neuronNum) + " does not exist in layer " + std::to_string(layerNum) + " or is a bias neuron");
+    if (layer.size() <= 2)
+        throw Neural::InvalidInput("Layer " + std::to_string(layerNum) + " cannot lose its last neuron");
+
+    // The removed neuron always output constantOutput, the bias neuron
+    // (whose output is 1.0) takes over that contribution to the next layer.
+    Neuron &bias = layer.back();
+    std::vector<Neural::INeuron::Connection> const &removed = layer[neuronNum].getConnection();
+    for (unsigned k = 0; k < removed.size(); ++k) {
+        Neural::INeuron::Connection data = bias.getConnection()[k];
+        data.weight += constantOutput * removed[k].weight;
+        bias.setConnection(k, data);
+    }
+
+    layer.erase(layer.begin() + neuronNum);
+    for (unsigned n = neuronNum; n < layer.size(); ++n) {
+        layer[n].setIndex(n);
+    }
+    for (auto &neuron: this->_layers[layerNum - 1]) {
+        neuron.removeConnection(neuronNum);
+    }
+    if (!this->_batchNorms[layerNum].empty())
+        this->_batchNorms[layerNum].erase(this->_batchNorms[layerNum].begin() + neuronNum);
+}
+
+void Neural::ANetworkData::foldBatchNorm() {
+    // y = scale * (W . x + b) + shift is W' = W * scale and b' = b * scale + shift
+    for (unsigned layerNum = 1; layerNum < this->_layers.size(); ++layerNum) {
+        std::vector<BatchNorm> &batchNorms = this->_batchNorms[layerNum];
+        Layer &prevLayer = this->_layers[layerNum - 1];
+        for (unsigned o = 0; o < batchNorms.size(); ++o) {
+            for (unsigned i = 0; i < prevLayer.size(); ++i) {
+                Neural::INeuron::Connection data = prevLayer[i].getConnection()[o];
+                data.weight *= batchNorms[o].getScale();
+                if (i == prevLayer.size() - 1)
+                    data.weight += batchNorms[o].getShift();
+                prevLayer[i].setConnection(o, data);
+            }
+        }
+        batchNorms.clear();
+    }
+}
+
+Neural::Topology Neural::ANetworkData::readTopology(std::ifstream &file) const {
     std::string line;
     std::string label;
 
@@ -114,13 +386,7 @@ std::vector<unsigned> Neural::ANetworkData::readTopology(std::ifstream &file) co
     if (file.eof() || label != "topology:") {
         throw Neural::InvalidTrainingFile("You training file does not contain a topology brief");
     }
-
-    while (!ss.eof()) {
-        unsigned n;
-        ss >> n;
-        topology.push_back(n);
-    }
-    return topology;
+    return Topology(line.substr(line.find(':') + 1));
 }
 
 std::vector<double> Neural::ANetworkData::readError(std::ifstream &file) const {
@@ -143,10 +409,18 @@ std::vector<double> Neural::ANetworkData::readError(std::ifstream &file) const {
     return error;
 }
 
-void Neural::ANetworkData::readNextNeuron(std::ifstream &file, std::vector<unsigned> &coord, Neural::INeuron::Connection &data) const {
-    std::string line;
+void Neural::ANetworkData::readBatchNorm(std::string const &line, std::string const &filepath) {
+    std::stringstream ss(line);
+    unsigned layerNum, neuronNum;
+    Neural::INeuron::Connection gamma, beta;
+    double mean, variance;
 
-    getline(file, line);
+    if (!(ss >> layerNum >> neuronNum >> gamma.weight >> gamma.deltaWeight >> beta.weight >> beta.deltaWeight >> mean >> variance) || layerNum >= this->_batchNorms.size() || neuronNum >= this->_batchNorms[layerNum].size())
+        throw Neural::InvalidSavingFile("Your saving file " + filepath + " references a batch normalization that does not exist in its topology");
+    this->_batchNorms[layerNum][neuronNum].setState(gamma, beta, mean, variance);
+}
+
+void Neural::ANetworkData::readNextNeuron(std::string const &line, std::vector<unsigned> &coord, Neural::INeuron::Connection &data) const {
     if (line.empty())
         return;
     std::stringstream ss(line);
@@ -170,15 +444,45 @@ double Neural::ANetworkData::getRecentAverageError(void) const {
     return this->_recentAverageError;
 }
 
+Neural::Topology Neural::ANetworkData::getTopology() const {
+    std::vector<std::string> transforms;
+    std::vector<unsigned> layers;
+
+    for (auto const &transform: this->_transforms) {
+        transforms.push_back(transform->getDescription());
+    }
+    for (auto const &layer: this->_layers) {
+        layers.push_back(layer.size() - 1);
+    }
+    Topology topology = this->_transforms.empty() ? Topology(layers, this->_loss) : Topology(this->_transforms.front()->getInputShape(), transforms, layers, this->_loss);
+    std::vector<bool> batchNorm;
+    for (auto const &layer: this->_batchNorms) {
+        batchNorm.push_back(!layer.empty());
+    }
+    topology.setDropout(this->_dropout);
+    topology.setBatchNorm(batchNorm);
+    return topology;
+}
+
+std::vector<std::vector<Neural::BatchNorm>> const &Neural::ANetworkData::getBatchNorms() const {
+    return this->_batchNorms;
+}
+
 std::vector<Neural::Layer> const & Neural::ANetworkData::getLayer() const {
     return this->_layers;
 }
 
+std::vector<std::unique_ptr<Neural::ITransformLayer>> const &Neural::ANetworkData::getTransforms() const {
+    return this->_transforms;
+}
+
 unsigned Neural::ANetworkData::getLayerCount() const {
     return this->_layers.size();
 }
 
 unsigned Neural::ANetworkData::getInputCount() const {
+    if (!this->_transforms.empty())
+        return this->_transforms.front()->getInputShape().size();
     return (this->_layers.empty() ? 0 : this->_layers.front().size() - 1);
 }
 
@@ -0,0 +1,103 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   15/05/2018 09:36:52
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 15/05/2018 18:04:19
+ */
+
+
+#include "BatchNorm.hpp"
+
+Neural::BatchNorm::BatchNorm(double momentum, double epsilon, double eta, double alpha) {
+    this->_momentum = momentum;
+    this->_epsilon = epsilon;
+    this->_eta = eta;
+    this->_alpha = alpha;
+    this->_gamma = INeuron::Connection{1.0, 0.0};
+    this->_beta = INeuron::Connection{0.0, 0.0};
+    this->_mean = 0.0;
+    this->_variance = 1.0;
+    this->_normalized = 0.0;
+}
+
+Neural::BatchNorm::~BatchNorm() {
+
+}
+
+Neural::BatchNorm::BatchNorm(const BatchNorm &batchNorm) {
+    *this = batchNorm;
+}
+
+Neural::BatchNorm &Neural::BatchNorm::operator =(const BatchNorm &batchNorm) {
+    this->_momentum = batchNorm._momentum;
+    this->_epsilon = batchNorm._epsilon;
+    this->_eta = batchNorm._eta;
+    this->_alpha = batchNorm._alpha;
+    this->_gamma = batchNorm._gamma;
+    this->_beta = batchNorm._beta;
+    this->_mean = batchNorm._mean;
+    this->_variance = batchNorm._variance;
+    this->_normalized = batchNorm._normalized;
+    return *this;
+}
+
+double Neural::BatchNorm::forward(double sum, bool training) {
+    if (training) {
+        // Exponential moving mean and variance
+        double delta = sum - this->_mean;
+        this->_mean += this->_momentum * delta;
+        this->_variance = (1.0 - this->_momentum) * (this->_variance + this->_momentum * delta * delta);
+    }
+    this->_normalized = (sum - this->_mean) / sqrt(this->_variance + this->_epsilon);
+    return this->_gamma.weight * this->_normalized + this->_beta.weight;
+}
+
+double Neural::BatchNorm::infer(double sum) const {
+    return this->_gamma.weight * ((sum - this->_mean) / sqrt(this->_variance + this->_epsilon)) + this->_beta.weight;
+}
+
+double Neural::BatchNorm::backward(double gradient) {
+    // The running statistics are treated as constants
+    double sumGradient = gradient * this->getScale();
+    this->update(this->_gamma, gradient * this->_normalized);
+    this->update(this->_beta, gradient);
+    return sumGradient;
+}
+
+double Neural::BatchNorm::getScale() const {
+    return this->_gamma.weight / sqrt(this->_variance + this->_epsilon);
+}
+
+double Neural::BatchNorm::getShift() const {
+    return this->_beta.weight - this->_mean * this->getScale();
+}
+
+Neural::INeuron::Connection const &Neural::BatchNorm::getGamma() const {
+    return this->_gamma;
+}
+
+Neural::INeuron::Connection const &Neural::BatchNorm::getBeta() const {
+    return this->_beta;
+}
+
+double Neural::BatchNorm::getMean() const {
+    return this->_mean;
+}
+
+double Neural::BatchNorm::getVariance() const {
+    return this->_variance;
+}
+
+void Neural::BatchNorm::setState(INeuron::Connection const &gamma, INeuron::Connection const &beta, double mean, double variance) {
+    this->_gamma = gamma;
+    this->_beta = beta;
+    this->_mean = mean;
+    this->_variance = variance;
+}
+
+void Neural::BatchNorm::update(INeuron::Connection &parameter, double gradient) {
+    // Same momentum rule as Neuron::updateInputWeights
+    parameter.deltaWeight = this->_eta * gradient + this->_alpha * parameter.deltaWeight;
+    parameter.weight += parameter.deltaWeight;
+}
@@ -0,0 +1,135 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   18/05/2018 09:02:44
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 18/05/2018 15:26:10
+ */
+
+
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Checkpointer.hpp"
+
+Neural::Checkpointer::Checkpointer(std::string const &path, unsigned long interval, double period) {
+    this->_path = path;
+    this->_interval = interval;
+    this->_period = std::chrono::duration<double>(period);
+    this->_samples = 0;
+    this->_last = std::chrono::steady_clock::now();
+    this->_writing = false;
+    this->_stop = false;
+    this->_saved = 0;
+    this->_worker = std::thread(&Checkpointer::run, this);
+}
+
+Neural::Checkpointer::~Checkpointer() {
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_stop = true;
+    }
+    this->_wake.notify_one();
+    this->_worker.join();
+}
+
+void Neural::Checkpointer::sample(Network const &network) {
+    this->_samples++;
+    // The clock is only read every 64 samples
+    bool due = this->_interval != 0 && this->_samples >= this->_interval;
+    if (!due && this->_period.count() > 0 && (this->_samples & 63) == 0)
+        due = std::chrono::steady_clock::now() - this->_last >= this->_period;
+    if (due)
+        this->save(network);
+}
+
+void Neural::Checkpointer::save(Network const &network) {
+    std::unique_ptr<Network> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        snapshot = std::move(this->_spare);
+    }
+    // The only work done on the training thread, a copy of the weights into existing vectors
+    if (snapshot)
+        *snapshot = network;
+    else
+        snapshot.reset(new Network(network));
+
+    this->_samples = 0;
+    this->_last = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        std::swap(this->_pending, snapshot);
+        if (snapshot && !this->_spare)
+            this->_spare = std::move(snapshot);
+    }
+    this->_wake.notify_one();
+}
+
+void Neural::Checkpointer::flush() {
+    std::unique_lock<std::mutex> lock(this->_mutex);
+
+    this->_written.wait(lock, [this]() { return !this->_pending && !this->_writing; });
+    if (this->_error) {
+        std::exception_ptr error = this->_error;
+        this->_error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+std::string const &Neural::Checkpointer::getPath() const {
+    return this->_path;
+}
+
+unsigned long Neural::Checkpointer::getSaved() const {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    return this->_saved;
+}
+
+void Neural::Checkpointer::write(Network const &network) {
+    std::string temporary = this->_path + ".tmp";
+
+    network.snapshot(this->_content);
+    ModelFile::write(temporary, this->_content);
+    // The data must be on disk before the rename makes it the checkpoint
+    int fd = open(temporary.c_str(), O_RDONLY);
+    if (fd < 0 || fsync(fd) != 0) {
+        if (fd >= 0)
+            close(fd);
+        throw Neural::InvalidSavingFile("The checkpoint " + temporary + " could not be synced");
+    }
+    close(fd);
+    if (std::rename(temporary.c_str(), this->_path.c_str()) != 0)
+        throw Neural::InvalidSavingFile("The checkpoint " + temporary + " could not be renamed to " + this->_path);
+}
+
+void Neural::Checkpointer::run() {
+    std::unique_lock<std::mutex> lock(this->_mutex);
+
+    while (true) {
+        this->_wake.wait(lock, [this]() { return this->_pending || this->_stop; });
+        if (!this->_pending)
+            return;
+        std::unique_ptr<Network> snapshot = std::move(this->_pending);
+        this->_writing = true;
+        lock.unlock();
+
+        std::exception_ptr error;
+        try {
+            this->write(*snapshot);
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        lock.lock();
+        if (!this->_spare)
+            this->_spare = std::move(snapshot);
+        this->_writing = false;
+        if (error)
+            this->_error = error;
+        else
+            this->_saved++;
+        this->_written.notify_all();
+    }
+}
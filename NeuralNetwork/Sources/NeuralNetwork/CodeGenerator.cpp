@@ -0,0 +1,152 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   08/05/2018 11:12:40
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 08/05/2018 16:38:55
+ */
+
+
+#include "CodeGenerator.hpp"
+
+Neural::CodeGenerator::CodeGenerator(OperatorGraph const &graph): _graph(graph) {
+    this->_graph.fuse();
+}
+
+Neural::CodeGenerator::~CodeGenerator() {
+
+}
+
+Neural::CodeGenerator::CodeGenerator(const CodeGenerator &generator): _graph(generator._graph) {
+
+}
+
+Neural::CodeGenerator &Neural::CodeGenerator::operator =(const CodeGenerator &generator) {
+    this->_graph = generator._graph;
+    return *this;
+}
+
+std::string Neural::CodeGenerator::generateSource() const {
+    std::stringstream os;
+
+    os << "// Generated by NeuralNetwork, do not edit" << std::endl;
+    os << "#include <cmath>" << std::endl << std::endl;
+    this->emitWeights(os, "static const");
+    os << std::endl;
+    os << "extern \"C\" unsigned neural_input_count() { return " << this->_graph.getInputCount() << "; }" << std::endl;
+    os << "extern \"C\" unsigned neural_output_count() { return " << this->_graph.getOutputCount() << "; }" << std::endl << std::endl;
+    os << "extern \"C\" void neural_predict(const double *input, double *output) {" << std::endl;
+    this->emitForward(os, "input", "output");
+    os << "}" << std::endl;
+    return os.str();
+}
+
+std::string Neural::CodeGenerator::generateHeader(std::string const &name) const {
+    std::stringstream os;
+    std::string guard;
+
+    for (auto c: name) {
+        guard += toupper(c);
+    }
+    guard += "_HPP_";
+    os << "// Generated by NeuralNetwork, do not edit" << std::endl;
+    os << "#ifndef " << guard << std::endl;
+    os << "#define " << guard << std::endl << std::endl;
+    os << "#include <cmath>" << std::endl << std::endl;
+    os << "namespace " << name << " {" << std::endl << std::endl;
+    os << "constexpr unsigned inputCount = " << this->_graph.getInputCount() << ";" << std::endl;
+    os << "constexpr unsigned outputCount = " << this->_graph.getOutputCount() << ";" << std::endl << std::endl;
+    this->emitWeights(os, "inline constexpr");
+    os << std::endl;
+    os << "inline void predict(const double *input, double *output) {" << std::endl;
+    this->emitForward(os, "input", "output");
+    os << "}" << std::endl << std::endl;
+    os << "}" << std::endl << std::endl;
+    os << "#endif /*" << guard << "*/" << std::endl;
+    return os.str();
+}
+
+std::uint64_t Neural::CodeGenerator::getHash() const {
+    // FNV-1a over the generated source, it covers both the topology and the weights
+    std::string source = this->generateSource();
+    std::uint64_t hash = 14695981039346656037ULL;
+
+    for (unsigned char c: source) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+Neural::OperatorGraph const &Neural::CodeGenerator::getGraph() const {
+    return this->_graph;
+}
+
+void Neural::CodeGenerator::emitWeights(std::ostream &os, std::string const &qualifier) const {
+    unsigned n = 0;
+
+    for (auto const &op: this->_graph.getOperators()) {
+        if (!op.weights.empty()) {
+            os << qualifier << " double w" << n << "[" << op.weights.size() << "] = ";
+            this->emitArray(os, op.weights);
+        }
+        if (!op.bias.empty()) {
+            os << qualifier << " double b" << n << "[" << op.bias.size() << "] = ";
+            this->emitArray(os, op.bias);
+        }
+        n++;
+    }
+}
+
+void Neural::CodeGenerator::emitForward(std::ostream &os, std::string const &input, std::string const &output) const {
+    std::vector<Neural::IOperatorGraph::Operator> const &operators = this->_graph.getOperators();
+    std::string source = input;
+
+    for (unsigned n = 0; n < operators.size(); ++n) {
+        Neural::IOperatorGraph::Operator const &op = operators[n];
+        std::string destination = n == operators.size() - 1 ? output : "l" + std::to_string(n);
+        std::string transfer = op.transfer == Neural::IOperatorGraph::Tanh ? "std::tanh" : "";
+
+        if (destination != output)
+            os << "    double " << destination << "[" << op.outputSize << "];" << std::endl;
+        switch (op.type) {
+        case Neural::IOperatorGraph::Dense:
+            os << "    for (unsigned o = 0; o < " << op.outputSize << "; ++o) {" << std::endl;
+            os << "        double sum = b" << n << "[o];" << std::endl;
+            os << "        for (unsigned i = 0; i < " << op.inputSize << "; ++i)" << std::endl;
+            os << "            sum += w" << n << "[o * " << op.inputSize << " + i] * " << source << "[i];" << std::endl;
+            os << "        " << destination << "[o] = " << transfer << "(sum);" << std::endl;
+            os << "    }" << std::endl;
+            break;
+        case Neural::IOperatorGraph::Softmax:
+            os << "    {" << std::endl;
+            os << "        double max = " << source << "[0], sum = 0.0;" << std::endl;
+            os << "        for (unsigned i = 1; i < " << op.outputSize << "; ++i)" << std::endl;
+            os << "            max = " << source << "[i] > max ? " << source << "[i] : max;" << std::endl;
+            os << "        for (unsigned i = 0; i < " << op.outputSize << "; ++i) {" << std::endl;
+            os << "            " << destination << "[i] = std::exp(" << source << "[i] - max);" << std::endl;
+            os << "            sum += " << destination << "[i];" << std::endl;
+            os << "        }" << std::endl;
+            os << "        for (unsigned i = 0; i < " << op.outputSize << "; ++i)" << std::endl;
+            os << "            " << destination << "[i] /= sum;" << std::endl;
+            os << "    }" << std::endl;
+            break;
+        case Neural::IOperatorGraph::Normalize:
+            os << "    for (unsigned i = 0; i < " << op.outputSize << "; ++i)" << std::endl;
+            os << "        " << destination << "[i] = " << source << "[i] * w" << n << "[i] + b" << n << "[i];" << std::endl;
+            break;
+        default:
+            throw Neural::CompilationError("Operator " + std::to_string(n) + " was not fused and cannot be generated");
+        }
+        source = destination;
+    }
+}
+
+void Neural::CodeGenerator::emitArray(std::ostream &os, std::vector<double> const &values) const {
+    // Hexadecimal literals keep every weight bit exact
+    os << "{" << std::hexfloat;
+    for (unsigned i = 0; i < values.size(); ++i) {
+        os << (i % 4 == 0 ? "\n    " : " ") << values[i] << (i + 1 < values.size() ? "," : "");
+    }
+    os << std::defaultfloat << "\n};" << std::endl;
+}
@@ -0,0 +1,182 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   08/05/2018 14:02:17
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 08/05/2018 16:39:03
+ */
+
+
+#include "CompiledNetwork.hpp"
+
+Neural::CompiledNetwork::CompiledNetwork(Network const &network, std::string const &cacheDirectory): _network(network) {
+    this->_handle = NULL;
+    this->_predict = NULL;
+    this->_fromCache = false;
+    this->compile(CodeGenerator(OperatorGraph(network)), cacheDirectory);
+    this->open();
+}
+
+Neural::CompiledNetwork::~CompiledNetwork() {
+    this->close();
+}
+
+Neural::CompiledNetwork::CompiledNetwork(const CompiledNetwork &network): _network(network._network) {
+    this->_handle = NULL;
+    this->_predict = NULL;
+    this->_libraryPath = network._libraryPath;
+    this->_fromCache = network._fromCache;
+    this->open();
+}
+
+Neural::CompiledNetwork &Neural::CompiledNetwork::operator =(const CompiledNetwork &network) {
+    if (this == &network)
+        return *this;
+    this->close();
+    this->_network = network._network;
+    this->_libraryPath = network._libraryPath;
+    this->_fromCache = network._fromCache;
+    this->open();
+    return *this;
+}
+
+void Neural::CompiledNetwork::train(INetworkTrainer const &trainer) {
+    (void)trainer;
+    throw Neural::NetworkException("A compiled network is frozen, train the source network and specialize it again");
+}
+
+void Neural::CompiledNetwork::feedForward(const std::vector<double> &inputVals) {
+    if (inputVals.size() != this->_inputCount) {
+        throw Neural::InvalidInput("You want to input " + std::to_string(inputVals.size()) + " values but your network can only accept " + std::to_string(this->_inputCount));
+    }
+    this->_results.resize(this->_outputCount);
+    this->_predict(inputVals.data(), this->_results.data());
+}
+
+std::vector<double> const Neural::CompiledNetwork::getResults() const {
+    return this->_results;
+}
+
+void Neural::CompiledNetwork::backProp(const std::vector<double> &targetVals) {
+    (void)targetVals;
+    throw Neural::NetworkException("A compiled network is frozen, train the source network and specialize it again");
+}
+
+void Neural::CompiledNetwork::errorPlot() const {
+    this->_network.errorPlot();
+}
+
+std::string const &Neural::CompiledNetwork::getLibraryPath() const {
+    return this->_libraryPath;
+}
+
+bool Neural::CompiledNetwork::isFromCache() const {
+    return this->_fromCache;
+}
+
+void Neural::CompiledNetwork::compile(CodeGenerator const &generator, std::string const &cacheDirectory) {
+    // CXX may hold a launcher or flags, the paths are given as they are and never seen by a shell
+    const char *compiler = getenv("CXX");
+    std::vector<std::string> arguments;
+    std::stringstream words(compiler ? compiler : "");
+    for (std::string word; words >> word;) {
+        arguments.push_back(word);
+    }
+    if (arguments.empty())
+        arguments.push_back("c++");
+    arguments.insert(arguments.end(), {"-std=c++17", "-O3", "-shared", "-fPIC"});
+
+    // The key goes on with the FNV-1a of the source over the command line, another compiler builds another object
+    std::uint64_t hash = generator.getHash();
+    for (auto const &argument: arguments) {
+        for (unsigned char c: argument + '\0') {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+    }
+    std::stringstream key;
+    key << std::hex << std::setw(16) << std::setfill('0') << hash;
+    std::string base = cacheDirectory + "/network_" + key.str();
+    this->_libraryPath = base + ".so";
+
+    struct stat info;
+    if (stat(this->_libraryPath.c_str(), &info) == 0) {
+        this->_fromCache = true;
+        return;
+    }
+
+    // Write and build next to the final names then rename, concurrent specializations never see a partial file
+    mkdir(cacheDirectory.c_str(), 0755);
+    std::string temporary = base + "." + std::to_string(getpid());
+    std::ofstream file((temporary + ".cpp").c_str());
+    if (!file)
+        throw Neural::CompilationError("The source file " + temporary + ".cpp could not be created");
+    file << generator.generateSource();
+    file.close();
+    if (!file) {
+        std::remove((temporary + ".cpp").c_str());
+        throw Neural::CompilationError("The source file " + temporary + ".cpp could not be written");
+    }
+
+    arguments.insert(arguments.end(), {"-o", temporary + ".so", temporary + ".cpp"});
+    if (!run(arguments)) {
+        std::remove((temporary + ".so").c_str());
+        std::remove((temporary + ".cpp").c_str());
+        std::string command;
+        for (auto const &argument: arguments) {
+            command += (command.empty() ? "" : " ") + argument;
+        }
+        throw Neural::CompilationError("The command `" + command + "` failed");
+    }
+    // The source stays next to its object for inspection
+    std::rename((temporary + ".cpp").c_str(), (base + ".cpp").c_str());
+    if (std::rename((temporary + ".so").c_str(), this->_libraryPath.c_str()) != 0) {
+        std::remove((temporary + ".so").c_str());
+        throw Neural::CompilationError("The shared object " + this->_libraryPath + " could not be moved in the cache");
+    }
+}
+
+void Neural::CompiledNetwork::open() {
+    this->_handle = dlopen(this->_libraryPath.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (this->_handle == NULL)
+        throw Neural::CompilationError("The shared object " + this->_libraryPath + " could not be loaded: " + dlerror());
+
+    CountFunction inputCount = reinterpret_cast<CountFunction>(dlsym(this->_handle, "neural_input_count"));
+    CountFunction outputCount = reinterpret_cast<CountFunction>(dlsym(this->_handle, "neural_output_count"));
+    this->_predict = reinterpret_cast<PredictFunction>(dlsym(this->_handle, "neural_predict"));
+    if (inputCount == NULL || outputCount == NULL || this->_predict == NULL) {
+        this->close();
+        throw Neural::CompilationError("The shared object " + this->_libraryPath + " is not a compiled network");
+    }
+    this->_inputCount = inputCount();
+    this->_outputCount = outputCount();
+}
+
+void Neural::CompiledNetwork::close() {
+    if (this->_handle != NULL)
+        dlclose(this->_handle);
+    this->_handle = NULL;
+    this->_predict = NULL;
+}
+
+bool Neural::CompiledNetwork::run(std::vector<std::string> const &arguments) {
+    std::vector<char *> argv;
+    for (auto const &argument: arguments) {
+        argv.push_back(const_cast<char *>(argument.c_str()));
+    }
+    argv.push_back(NULL);
+
+    pid_t pid = fork();
+    if (pid < 0)
+        return false;
+    if (pid == 0) {
+        execvp(argv[0], argv.data());
+        _exit(127);
+    }
+    int status;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR)
+            return false;
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
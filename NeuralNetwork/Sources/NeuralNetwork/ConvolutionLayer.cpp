@@ -0,0 +1,273 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   10/05/2018 13:47:36
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 10/05/2018 18:52:51
+ */
+
+
+#include "ConvolutionLayer.hpp"
+
+Neural::Shape Neural::ConvolutionLayer::outputShape(Shape const &inputShape, unsigned filters, unsigned kernel) {
+    if (kernel == 0 || filters == 0 || kernel > inputShape.height || kernel > inputShape.width)
+        throw Neural::InvalidTrainingFile("A " + std::to_string(kernel) + "x" + std::to_string(kernel) + " convolution does not fit a " + inputShape.toString() + " input");
+    return Neural::Shape{filters, inputShape.height - kernel + 1, inputShape.width - kernel + 1};
+}
+
+Neural::ConvolutionLayer::ConvolutionLayer(Shape const &inputShape, unsigned filters, unsigned kernel, Random &random, Algorithm algorithm): ATransformLayer(inputShape, outputShape(inputShape, filters, kernel)) {
+    this->_filters = filters;
+    this->_kernel = kernel;
+    this->_algorithm = algorithm;
+    this->_gradients.assign(this->_outputShape.size(), 0.0);
+
+    // Parameters are the kernels [filter][channel][ky][kx] followed by one bias per filter
+    unsigned fanIn = inputShape.channels * kernel * kernel;
+    for (unsigned n = 0; n < filters * fanIn; ++n) {
+        this->_parameters.push_back(Neural::INeuron::Connection{this->randomWeight(random, fanIn), 0.0});
+    }
+    for (unsigned f = 0; f < filters; ++f) {
+        this->_parameters.push_back(Neural::INeuron::Connection{0.0, 0.0});
+    }
+}
+
+Neural::ConvolutionLayer::~ConvolutionLayer() {
+
+}
+
+Neural::ConvolutionLayer::ConvolutionLayer(const ConvolutionLayer &layer): ATransformLayer(layer) {
+    this->_filters = layer._filters;
+    this->_kernel = layer._kernel;
+    this->_algorithm = layer._algorithm;
+    this->_input = layer._input;
+    this->_columns = layer._columns;
+    this->_gradients = layer._gradients;
+}
+
+Neural::ConvolutionLayer &Neural::ConvolutionLayer::operator =(const ConvolutionLayer &layer) {
+    Neural::ATransformLayer::operator=(layer);
+    this->_filters = layer._filters;
+    this->_kernel = layer._kernel;
+    this->_algorithm = layer._algorithm;
+    this->_input = layer._input;
+    this->_columns = layer._columns;
+    this->_gradients = layer._gradients;
+    return *this;
+}
+
+std::string Neural::ConvolutionLayer::getDescription() const {
+    std::string description = "conv:" + std::to_string(this->_filters) + ":" + std::to_string(this->_kernel);
+
+    if (this->_algorithm == Gemm)
+        description += ":gemm";
+    else if (this->_algorithm == Direct)
+        description += ":direct";
+    return description;
+}
+
+void Neural::ConvolutionLayer::feedForward(const std::vector<double> &input) {
+    this->checkInput(input);
+    this->_input = input;
+    this->forward(this->_input.data(), this->_output.data(), this->_columns);
+}
+
+void Neural::ConvolutionLayer::predict(const std::vector<double> &input, std::vector<double> &output, std::vector<double> &scratch) const {
+    this->checkInput(input);
+    output.resize(this->_outputShape.size());
+    this->forward(input.data(), output.data(), scratch);
+}
+
+void Neural::ConvolutionLayer::forward(const double *input, double *output, std::vector<double> &columns) const {
+    if (this->isDirect())
+        this->forwardDirect3x3(input, output);
+    else
+        this->forwardGemm(input, output, columns);
+    for (unsigned n = 0; n < this->_outputShape.size(); ++n) {
+        output[n] = tanh(output[n]);
+    }
+}
+
+void Neural::ConvolutionLayer::backProp(const std::vector<double> &outputGradients) {
+    // Gradient at the convolution sum, through the tanh derivative
+    for (unsigned n = 0; n < this->_output.size(); ++n) {
+        this->_gradients[n] = outputGradients[n] * (1.0 - this->_output[n] * this->_output[n]);
+    }
+
+    if (this->isDirect())
+        this->backwardDirect();
+    else
+        this->backwardGemm();
+}
+
+Neural::ITransformLayer *Neural::ConvolutionLayer::clone() const {
+    return new ConvolutionLayer(*this);
+}
+
+bool Neural::ConvolutionLayer::isDirect() const {
+    // The direct kernels are written for a 3x3 window
+    return this->_kernel == 3 && this->_algorithm != Gemm;
+}
+
+void Neural::ConvolutionLayer::im2col(const double *input, std::vector<double> &columns) const {
+    unsigned k = this->_kernel;
+    unsigned pixels = this->_outputShape.height * this->_outputShape.width;
+    columns.resize(this->_inputShape.channels * k * k * pixels);
+
+    double *column = columns.data();
+    for (unsigned c = 0; c < this->_inputShape.channels; ++c) {
+        const double *plane = input + c * this->_inputShape.height * this->_inputShape.width;
+        for (unsigned ky = 0; ky < k; ++ky) {
+            for (unsigned kx = 0; kx < k; ++kx) {
+                for (unsigned y = 0; y < this->_outputShape.height; ++y) {
+                    const double *row = plane + (y + ky) * this->_inputShape.width + kx;
+                    for (unsigned x = 0; x < this->_outputShape.width; ++x) {
+                        *column++ = row[x];
+                    }
+                }
+            }
+        }
+    }
+}
+
+void Neural::ConvolutionLayer::forwardGemm(const double *input, double *result, std::vector<double> &columns) const {
+    unsigned pixels = this->_outputShape.height * this->_outputShape.width;
+    unsigned rows = this->_inputShape.channels * this->_kernel * this->_kernel;
+    const Neural::INeuron::Connection *bias = this->_parameters.data() + this->_filters * rows;
+
+    this->im2col(input, columns);
+    // output[filters][pixels] = kernels[filters][rows] . columns[rows][pixels], inner loop runs over contiguous pixels
+    for (unsigned f = 0; f < this->_filters; ++f) {
+        double *output = result + f * pixels;
+        for (unsigned p = 0; p < pixels; ++p) {
+            output[p] = bias[f].weight;
+        }
+        for (unsigned r = 0; r < rows; ++r) {
+            double weight = this->_parameters[f * rows + r].weight;
+            const double *column = columns.data() + r * pixels;
+            for (unsigned p = 0; p < pixels; ++p) {
+                output[p] += weight * column[p];
+            }
+        }
+    }
+}
+
+void Neural::ConvolutionLayer::forwardDirect3x3(const double *input, double *result) const {
+    unsigned width = this->_inputShape.width;
+    unsigned outHeight = this->_outputShape.height;
+    unsigned outWidth = this->_outputShape.width;
+    unsigned channels = this->_inputShape.channels;
+    const Neural::INeuron::Connection *bias = this->_parameters.data() + this->_filters * channels * 9;
+
+    for (unsigned f = 0; f < this->_filters; ++f) {
+        double *output = result + f * outHeight * outWidth;
+        for (unsigned p = 0; p < outHeight * outWidth; ++p) {
+            output[p] = bias[f].weight;
+        }
+        for (unsigned c = 0; c < channels; ++c) {
+            const Neural::INeuron::Connection *w = this->_parameters.data() + (f * channels + c) * 9;
+            double w0 = w[0].weight, w1 = w[1].weight, w2 = w[2].weight;
+            double w3 = w[3].weight, w4 = w[4].weight, w5 = w[5].weight;
+            double w6 = w[6].weight, w7 = w[7].weight, w8 = w[8].weight;
+            const double *plane = input + c * this->_inputShape.height * width;
+            for (unsigned y = 0; y < outHeight; ++y) {
+                const double *r0 = plane + y * width;
+                const double *r1 = r0 + width;
+                const double *r2 = r1 + width;
+                double *o = output + y * outWidth;
+                for (unsigned x = 0; x < outWidth; ++x) {
+                    o[x] += w0 * r0[x] + w1 * r0[x + 1] + w2 * r0[x + 2]
+                          + w3 * r1[x] + w4 * r1[x + 1] + w5 * r1[x + 2]
+                          + w6 * r2[x] + w7 * r2[x + 1] + w8 * r2[x + 2];
+                }
+            }
+        }
+    }
+}
+
+void Neural::ConvolutionLayer::backwardGemm() {
+    unsigned k = this->_kernel;
+    unsigned pixels = this->_outputShape.height * this->_outputShape.width;
+    unsigned rows = this->_inputShape.channels * k * k;
+
+    // Input gradients first, with the weights used by the forward pass:
+    // dColumns[rows][pixels] = kernels^T . gradients, then scattered back by col2im
+    std::fill(this->_inputGradients.begin(), this->_inputGradients.end(), 0.0);
+    std::vector<double> row(pixels);
+    for (unsigned r = 0; r < rows; ++r) {
+        std::fill(row.begin(), row.end(), 0.0);
+        for (unsigned f = 0; f < this->_filters; ++f) {
+            double weight = this->_parameters[f * rows + r].weight;
+            const double *gradient = this->_gradients.data() + f * pixels;
+            for (unsigned p = 0; p < pixels; ++p) {
+                row[p] += weight * gradient[p];
+            }
+        }
+        unsigned c = r / (k * k);
+        unsigned ky = (r / k) % k;
+        unsigned kx = r % k;
+        double *plane = this->_inputGradients.data() + c * this->_inputShape.height * this->_inputShape.width;
+        for (unsigned y = 0; y < this->_outputShape.height; ++y) {
+            for (unsigned x = 0; x < this->_outputShape.width; ++x) {
+                plane[(y + ky) * this->_inputShape.width + x + kx] += row[y * this->_outputShape.width + x];
+            }
+        }
+    }
+
+    // dKernels[filters][rows] = gradients . columns^T
+    for (unsigned f = 0; f < this->_filters; ++f) {
+        const double *gradient = this->_gradients.data() + f * pixels;
+        double biasGradient = 0.0;
+        for (unsigned p = 0; p < pixels; ++p) {
+            biasGradient += gradient[p];
+        }
+        for (unsigned r = 0; r < rows; ++r) {
+            const double *column = this->_columns.data() + r * pixels;
+            double sum = 0.0;
+            for (unsigned p = 0; p < pixels; ++p) {
+                sum += gradient[p] * column[p];
+            }
+            this->updateParameter(f * rows + r, sum);
+        }
+        this->updateParameter(this->_filters * rows + f, biasGradient);
+    }
+}
+
+void Neural::ConvolutionLayer::backwardDirect() {
+    unsigned k = this->_kernel;
+    unsigned width = this->_inputShape.width;
+    unsigned planeSize = this->_inputShape.height * width;
+    unsigned outHeight = this->_outputShape.height;
+    unsigned outWidth = this->_outputShape.width;
+    unsigned channels = this->_inputShape.channels;
+
+    std::fill(this->_inputGradients.begin(), this->_inputGradients.end(), 0.0);
+    for (unsigned f = 0; f < this->_filters; ++f) {
+        const double *gradient = this->_gradients.data() + f * outHeight * outWidth;
+        double biasGradient = 0.0;
+        for (unsigned p = 0; p < outHeight * outWidth; ++p) {
+            biasGradient += gradient[p];
+        }
+        for (unsigned c = 0; c < channels; ++c) {
+            const double *plane = this->_input.data() + c * planeSize;
+            double *inputGradient = this->_inputGradients.data() + c * planeSize;
+            for (unsigned ky = 0; ky < k; ++ky) {
+                for (unsigned kx = 0; kx < k; ++kx) {
+                    unsigned index = ((f * channels + c) * k + ky) * k + kx;
+                    double weight = this->_parameters[index].weight;
+                    double sum = 0.0;
+                    for (unsigned y = 0; y < outHeight; ++y) {
+                        const double *in = plane + (y + ky) * width + kx;
+                        double *dIn = inputGradient + (y + ky) * width + kx;
+                        const double *g = gradient + y * outWidth;
+                        for (unsigned x = 0; x < outWidth; ++x) {
+                            sum += g[x] * in[x];
+                            dIn[x] += weight * g[x];
+                        }
+                    }
+                    this->updateParameter(index, sum);
+                }
+            }
+        }
+        this->updateParameter(this->_filters * channels * k * k + f, biasGradient);
+    }
+}
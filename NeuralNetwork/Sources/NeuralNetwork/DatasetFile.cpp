@@ -0,0 +1,209 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   23/05/2018 10:04:26
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 23/05/2018 18:12:50
+ */
+
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "DatasetFile.hpp"
+
+static const char Magic[8] = {'D', 'N', 'N', 'D', 'A', 'T', 'A', 'S'};
+static const uint32_t ByteOrder = 0x01020304;
+
+Neural::DatasetFile::Writer::Writer(std::string const &path, std::string const &topology, Precision precision) {
+    this->_path = path;
+    this->_closed = false;
+    this->_file.open(path.c_str(), std::ios::binary);
+    if (!this->_file)
+        throw Neural::InvalidTrainingFile("The data set " + path + " could not be created");
+
+    this->_header = Header{};
+    memcpy(this->_header.magic, Magic, sizeof(Magic));
+    this->_header.version = Version;
+    this->_header.byteOrder = ByteOrder;
+    this->_header.topologySize = topology.size();
+    this->_header.precision = precision;
+    this->_header.inputsOffset = align(sizeof(Header) + topology.size());
+
+    // The header is written again once the sizes are known
+    std::vector<char> start(this->_header.inputsOffset, 0);
+    memcpy(start.data() + sizeof(Header), topology.data(), topology.size());
+    this->_file.write(start.data(), start.size());
+}
+
+Neural::DatasetFile::Writer::~Writer() {
+    try {
+        this->close();
+    } catch (std::exception const &) {
+    }
+}
+
+void Neural::DatasetFile::Writer::add(std::vector<double> const &input, std::vector<double> const &output) {
+    if (this->_header.sampleCount == 0) {
+        this->_header.inputs = input.size();
+        this->_header.outputs = output.size();
+    } else if (input.size() != this->_header.inputs || output.size() != this->_header.outputs) {
+        throw Neural::InvalidTrainingFile("Every sample of the data set " + this->_path + " must have " + std::to_string(this->_header.inputs) + " inputs and " + std::to_string(this->_header.outputs) + " outputs");
+    }
+    this->_row.resize(input.size() * elementSize(this->_header.precision));
+    this->encode(input, this->_row.data());
+    this->_file.write(reinterpret_cast<const char *>(this->_row.data()), this->_row.size());
+    this->_outputs.resize(this->_outputs.size() + output.size() * elementSize(this->_header.precision));
+    this->encode(output, this->_outputs.data() + this->_outputs.size() - output.size() * elementSize(this->_header.precision));
+    this->_header.sampleCount++;
+}
+
+void Neural::DatasetFile::Writer::close() {
+    if (this->_closed)
+        return;
+    this->_closed = true;
+
+    std::vector<char> padding(64, 0);
+    uint64_t end = this->_header.inputsOffset + this->_header.sampleCount * this->_header.inputs * elementSize(this->_header.precision);
+    this->_header.outputsOffset = align(end);
+    this->_file.write(padding.data(), this->_header.outputsOffset - end);
+    this->_file.write(reinterpret_cast<const char *>(this->_outputs.data()), this->_outputs.size());
+    end = this->_header.outputsOffset + this->_outputs.size();
+    this->_header.fileSize = align(end);
+    this->_file.write(padding.data(), this->_header.fileSize - end);
+    this->_file.seekp(0);
+    this->_file.write(reinterpret_cast<const char *>(&this->_header), sizeof(Header));
+    this->_file.close();
+    std::vector<unsigned char>().swap(this->_outputs);
+    if (!this->_file)
+        throw Neural::InvalidTrainingFile("The data set " + this->_path + " could not be written");
+}
+
+uint64_t Neural::DatasetFile::Writer::getSampleCount() const {
+    return this->_header.sampleCount;
+}
+
+void Neural::DatasetFile::Writer::encode(std::vector<double> const &values, unsigned char *data) const {
+    if (this->_header.precision == Float64) {
+        memcpy(data, values.data(), values.size() * sizeof(double));
+        return;
+    }
+    for (size_t n = 0; n < values.size(); ++n) {
+        float value = values[n];
+        memcpy(data + n * sizeof(float), &value, sizeof(float));
+    }
+}
+
+Neural::DatasetFile::DatasetFile(std::string const &path) {
+    this->_path = path;
+    this->_data = nullptr;
+    this->_size = 0;
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw Neural::InvalidTrainingFile("Your data set " + path + " could not be opened: " + strerror(errno));
+    struct stat status;
+    if (fstat(fd, &status) < 0 || (size_t)status.st_size < sizeof(Header)) {
+        close(fd);
+        throw Neural::InvalidTrainingFile("Your data set " + path + " is too small to be a binary data set");
+    }
+    this->_size = status.st_size;
+    void *data = mmap(nullptr, this->_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        throw Neural::InvalidTrainingFile("Your data set " + path + " could not be mapped: " + strerror(errno));
+    this->_data = static_cast<const unsigned char *>(data);
+    this->_header = reinterpret_cast<const Header *>(this->_data);
+
+    // A matrix of rows of width values from offset, within the file
+    auto fits = [this](uint64_t offset, uint64_t width) {
+        uint64_t rowSize = width * elementSize(this->_header->precision);
+        return offset % 64 == 0 && offset <= this->_size && (rowSize == 0 || this->_header->sampleCount <= (this->_size - offset) / rowSize);
+    };
+    std::string error;
+    if (memcmp(this->_header->magic, Magic, sizeof(Magic)) != 0)
+        error = "is not a binary data set";
+    else if (this->_header->version != Version)
+        error = "has the version " + std::to_string(this->_header->version) + ", only the version " + std::to_string(Version) + " is supported";
+    else if (this->_header->byteOrder != ByteOrder)
+        error = "was written with another byte order";
+    else if (this->_header->fileSize != this->_size)
+        error = "is truncated";
+    else if (this->_header->precision > Float32)
+        error = "has values of an unknown precision";
+    else if (sizeof(Header) + (uint64_t)this->_header->topologySize > this->_header->inputsOffset || !fits(this->_header->inputsOffset, this->_header->inputs) || !fits(this->_header->outputsOffset, this->_header->outputs))
+        error = "has samples out of the file";
+    if (!error.empty()) {
+        munmap(const_cast<unsigned char *>(this->_data), this->_size);
+        throw Neural::InvalidTrainingFile("Your data set " + path + " " + error);
+    }
+}
+
+Neural::DatasetFile::~DatasetFile() {
+    munmap(const_cast<unsigned char *>(this->_data), this->_size);
+}
+
+bool Neural::DatasetFile::isDatasetFile(std::string const &path) {
+    std::ifstream file(path.c_str(), std::ios::binary);
+    char magic[sizeof(Magic)];
+
+    return file.read(magic, sizeof(magic)) && memcmp(magic, Magic, sizeof(Magic)) == 0;
+}
+
+Neural::DatasetFile::Precision Neural::DatasetFile::parsePrecision(std::string const &name) {
+    if (name == "float64")
+        return Float64;
+    if (name == "float32")
+        return Float32;
+    throw Neural::NetworkException("Unknown data set precision " + name + ", expected float64 or float32");
+}
+
+std::string Neural::DatasetFile::getTopologyBrief() const {
+    return std::string(reinterpret_cast<const char *>(this->_data + sizeof(Header)), this->_header->topologySize);
+}
+
+uint64_t Neural::DatasetFile::getSampleCount() const {
+    return this->_header->sampleCount;
+}
+
+unsigned Neural::DatasetFile::getInputCount() const {
+    return this->_header->inputs;
+}
+
+unsigned Neural::DatasetFile::getOutputCount() const {
+    return this->_header->outputs;
+}
+
+Neural::DatasetFile::Precision Neural::DatasetFile::getPrecision() const {
+    return static_cast<Precision>(this->_header->precision);
+}
+
+void Neural::DatasetFile::getSample(uint64_t index, std::vector<double> &input, std::vector<double> &output) const {
+    uint64_t size = elementSize(this->_header->precision);
+    this->decode(this->_header->inputsOffset + index * this->_header->inputs * size, this->_header->inputs, input);
+    this->decode(this->_header->outputsOffset + index * this->_header->outputs * size, this->_header->outputs, output);
+}
+
+uint64_t Neural::DatasetFile::align(uint64_t offset) {
+    return (offset + 63) & ~(uint64_t)63;
+}
+
+uint64_t Neural::DatasetFile::elementSize(uint32_t precision) {
+    return precision == Float64 ? sizeof(double) : sizeof(float);
+}
+
+void Neural::DatasetFile::decode(uint64_t offset, unsigned count, std::vector<double> &values) const {
+    const unsigned char *data = this->_data + offset;
+
+    if (this->_header->precision == Float64) {
+        const double *row = reinterpret_cast<const double *>(data);
+        values.assign(row, row + count);
+        return;
+    }
+    const float *row = reinterpret_cast<const float *>(data);
+    values.assign(row, row + count);
+}
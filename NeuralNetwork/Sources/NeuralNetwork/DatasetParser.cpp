@@ -0,0 +1,228 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   22/05/2018 09:47:12
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 22/05/2018 16:30:41
+ */
+
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "DatasetParser.hpp"
+
+static const char *skipSpaces(const char *cursor, const char *end) {
+    while (cursor != end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\r' || *cursor == '\v' || *cursor == '\f'))
+        cursor++;
+    return cursor;
+}
+
+// True when the first word of [cursor, end[ is label, cursor is then moved after it
+static bool readLabel(const char *&cursor, const char *end, const char *label) {
+    size_t length = strlen(label);
+
+    cursor = skipSpaces(cursor, end);
+    if ((size_t)(end - cursor) < length || memcmp(cursor, label, length) != 0)
+        return false;
+    if (cursor + length != end && skipSpaces(cursor + length, end) == cursor + length)
+        return false;
+    cursor += length;
+    return true;
+}
+
+// Plain decimals ("-0.25", "1.", "3") with at most 2^53 as digits and 22 decimals: both
+// the digits and the power of ten are exact doubles, so one division is correctly rounded
+// and gives the value of from_chars. Anything else returns nullptr and is left to from_chars.
+static const char *parseDecimal(const char *cursor, const char *end, double &value) {
+    static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    bool negative = cursor != end && *cursor == '-';
+    cursor += negative;
+
+    uint64_t digits = 0;
+    unsigned count = 0;
+    unsigned decimals = 0;
+    while (cursor != end && (unsigned)(*cursor - '0') < 10) {
+        digits = digits * 10 + (*cursor++ - '0');
+        count++;
+    }
+    if (cursor != end && *cursor == '.') {
+        cursor++;
+        while (cursor != end && (unsigned)(*cursor - '0') < 10) {
+            digits = digits * 10 + (*cursor++ - '0');
+            count++;
+            decimals++;
+        }
+    }
+    if (count == 0 || count > 19 || decimals > 22 || digits > (1ull << 53) || (cursor != end && (*cursor == 'e' || *cursor == 'E')))
+        return nullptr;
+    value = (double)digits / powers[decimals];
+    if (negative)
+        value = -value;
+    return cursor;
+}
+
+Neural::DatasetParser::DatasetParser(std::string const &path) {
+    this->_path = path;
+    this->_data = nullptr;
+    this->_size = 0;
+    this->_done = false;
+    this->_eof = false;
+    this->_inputs = 0;
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw Neural::InvalidTrainingFile("Your training file " + path + " could not be found");
+    struct stat status;
+    if (fstat(fd, &status) < 0) {
+        close(fd);
+        throw Neural::InvalidTrainingFile("Your training file " + path + " could not be found");
+    }
+    this->_size = status.st_size;
+    if (this->_size > 0) {
+        void *data = mmap(nullptr, this->_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            this->_data = static_cast<const char *>(data);
+            madvise(data, this->_size, MADV_SEQUENTIAL);
+        }
+    }
+    close(fd);
+    if (this->_size > 0 && this->_data == nullptr)
+        throw Neural::InvalidTrainingFile("Your training file " + path + " could not be mapped");
+    this->_cursor = this->_data;
+
+    // The brief must be a whole line, followed by the samples
+    const char *newline = this->_size > 0 ? static_cast<const char *>(memchr(this->_data, '\n', this->_size)) : nullptr;
+    const char *cursor = this->_data;
+    if (newline == nullptr || !readLabel(cursor, newline, "topology:")) {
+        if (this->_data != nullptr)
+            munmap(const_cast<char *>(this->_data), this->_size);
+        throw Neural::InvalidTrainingFile("You training file does not contain a topology brief");
+    }
+    this->_topology = Topology(std::string(cursor, newline));
+    this->_cursor = newline + 1;
+    this->_end = this->_data + this->_size;
+}
+
+Neural::DatasetParser::~DatasetParser() {
+    if (this->_data != nullptr)
+        munmap(const_cast<char *>(this->_data), this->_size);
+}
+
+Neural::Topology const &Neural::DatasetParser::getTopology() const {
+    return this->_topology;
+}
+
+bool Neural::DatasetParser::next(std::vector<double> &values, unsigned &inputs, unsigned &outputs) {
+    size_t begin = values.size();
+
+    if (!this->sample(values, values))
+        return false;
+    inputs = this->_inputs;
+    outputs = values.size() - begin - inputs;
+    return true;
+}
+
+bool Neural::DatasetParser::next(std::vector<double> &input, std::vector<double> &output) {
+    input.clear();
+    output.clear();
+    return this->sample(input, output);
+}
+
+size_t Neural::DatasetParser::getPosition() const {
+    return this->_cursor - this->_data;
+}
+
+size_t Neural::DatasetParser::getSize() const {
+    return this->_size;
+}
+
+size_t Neural::DatasetParser::findRecord(size_t position) const {
+    const char *end = this->_data + this->_size;
+    const char *line = this->_data + std::min(position, this->_size);
+
+    if (line != this->_data && line != end && line[-1] != '\n') {
+        const char *newline = static_cast<const char *>(memchr(line, '\n', end - line));
+        line = newline ? newline + 1 : end;
+    }
+    while (line != end) {
+        const char *newline = static_cast<const char *>(memchr(line, '\n', end - line));
+        const char *cursor = line;
+        if (readLabel(cursor, newline ? newline : end, "in:"))
+            return line - this->_data;
+        line = newline ? newline + 1 : end;
+    }
+    return this->_size;
+}
+
+void Neural::DatasetParser::setRange(size_t begin, size_t end) {
+    this->_cursor = this->_data + std::min(begin, this->_size);
+    this->_end = this->_data + std::min(end, this->_size);
+    this->_done = false;
+    this->_eof = false;
+}
+
+bool Neural::DatasetParser::hasStopped() const {
+    return this->_done;
+}
+
+bool Neural::DatasetParser::sample(std::vector<double> &input, std::vector<double> &output) {
+    if (this->_done || this->_eof) {
+        this->_done = true;
+        return false;
+    }
+    // The "out:" line of the last sample may lie past the end of the range, never its "in:" line
+    if (this->_cursor >= this->_end)
+        return false;
+    size_t inputBegin = input.size();
+    this->readLine("in:", input);
+    this->_inputs = input.size() - inputBegin;
+    if (this->_inputs == 0) {
+        this->_done = true;
+        return false;
+    }
+    if (this->_eof)
+        throw Neural::InvalidTrainingFile("You training file is giving an input sample without specifying an output corresponding");
+    size_t outputBegin = output.size();
+    this->readLine("out:", output);
+    if (output.size() == outputBegin)
+        throw Neural::InvalidTrainingFile("You training file is giving an input sample without specifying an output corresponding");
+    return true;
+}
+
+void Neural::DatasetParser::readLine(const char *label, std::vector<double> &values) {
+    const char *end = this->_data + this->_size;
+    if (this->_cursor == end) {
+        this->_eof = true;
+        return;
+    }
+    const char *newline = static_cast<const char *>(memchr(this->_cursor, '\n', end - this->_cursor));
+    const char *lineEnd = newline ? newline : end;
+    const char *cursor = this->_cursor;
+    this->_cursor = newline ? newline + 1 : end;
+    this->_eof = newline == nullptr;
+
+    if (!readLabel(cursor, lineEnd, label))
+        return;
+    // Same values as operator>>, which stops at the first word that is not a number
+    while (true) {
+        cursor = skipSpaces(cursor, lineEnd);
+        if (cursor != lineEnd && *cursor == '+')
+            cursor++;
+        double value;
+        const char *parsed = parseDecimal(cursor, lineEnd, value);
+        if (parsed == nullptr) {
+            std::from_chars_result result = std::from_chars(cursor, lineEnd, value);
+            if (result.ec != std::errc())
+                break;
+            parsed = result.ptr;
+        }
+        values.push_back(value);
+        cursor = parsed;
+    }
+}
@@ -0,0 +1,105 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   13/05/2018 09:42:08
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 13/05/2018 15:26:40
+ */
+
+
+#include "EmbeddingLayer.hpp"
+
+Neural::Shape Neural::EmbeddingLayer::outputShape(Shape const &inputShape, unsigned vocabulary, unsigned dimension) {
+    if (vocabulary == 0 || dimension == 0)
+        throw Neural::InvalidTrainingFile("An embedding needs a vocabulary and a dimension greater than 0");
+    return Neural::Shape{1, inputShape.size(), dimension};
+}
+
+Neural::EmbeddingLayer::EmbeddingLayer(Shape const &inputShape, unsigned vocabulary, unsigned dimension, Random &random): ATransformLayer(inputShape, outputShape(inputShape, vocabulary, dimension)) {
+    this->_vocabulary = vocabulary;
+    this->_dimension = dimension;
+    for (unsigned n = 0; n < vocabulary * dimension; ++n) {
+        this->_parameters.push_back(Neural::INeuron::Connection{this->randomWeight(random, 1), 0.0});
+    }
+    this->_ids.assign(inputShape.size(), 0);
+    this->_gradients.assign(vocabulary * dimension, 0.0);
+}
+
+Neural::EmbeddingLayer::~EmbeddingLayer() {
+
+}
+
+Neural::EmbeddingLayer::EmbeddingLayer(const EmbeddingLayer &layer): ATransformLayer(layer) {
+    this->_vocabulary = layer._vocabulary;
+    this->_dimension = layer._dimension;
+    this->_ids = layer._ids;
+    this->_touched = layer._touched;
+    this->_gradients = layer._gradients;
+}
+
+Neural::EmbeddingLayer &Neural::EmbeddingLayer::operator =(const EmbeddingLayer &layer) {
+    Neural::ATransformLayer::operator=(layer);
+    this->_vocabulary = layer._vocabulary;
+    this->_dimension = layer._dimension;
+    this->_ids = layer._ids;
+    this->_touched = layer._touched;
+    this->_gradients = layer._gradients;
+    return *this;
+}
+
+std::string Neural::EmbeddingLayer::getDescription() const {
+    return "embed:" + std::to_string(this->_vocabulary) + ":" + std::to_string(this->_dimension);
+}
+
+void Neural::EmbeddingLayer::feedForward(const std::vector<double> &input) {
+    this->checkInput(input);
+    this->lookup(input, this->_output.data(), this->_ids.data());
+}
+
+void Neural::EmbeddingLayer::predict(const std::vector<double> &input, std::vector<double> &output, std::vector<double> &) const {
+    this->checkInput(input);
+    output.resize(this->_outputShape.size());
+    this->lookup(input, output.data(), nullptr);
+}
+
+void Neural::EmbeddingLayer::lookup(const std::vector<double> &input, double *result, unsigned *ids) const {
+    for (unsigned n = 0; n < input.size(); ++n) {
+        if (input[n] < 0 || input[n] >= this->_vocabulary || input[n] != floor(input[n]))
+            throw Neural::InvalidInput("The id " + std::to_string(input[n]) + " is not in the vocabulary of the layer " + this->getDescription());
+        unsigned id = input[n];
+        if (ids)
+            ids[n] = id;
+        const Neural::INeuron::Connection *row = this->_parameters.data() + id * this->_dimension;
+        double *output = result + n * this->_dimension;
+        for (unsigned d = 0; d < this->_dimension; ++d) {
+            output[d] = row[d].weight;
+        }
+    }
+}
+
+void Neural::EmbeddingLayer::backProp(const std::vector<double> &outputGradients) {
+    // Gather the gradients of repeated ids first so that every row is updated once
+    this->_touched.clear();
+    for (unsigned n = 0; n < this->_ids.size(); ++n) {
+        unsigned id = this->_ids[n];
+        double *gradient = this->_gradients.data() + id * this->_dimension;
+        const double *outputGradient = outputGradients.data() + n * this->_dimension;
+        if (std::find(this->_touched.begin(), this->_touched.end(), id) == this->_touched.end())
+            this->_touched.push_back(id);
+        for (unsigned d = 0; d < this->_dimension; ++d) {
+            gradient[d] += outputGradient[d];
+        }
+    }
+    for (auto id: this->_touched) {
+        double *gradient = this->_gradients.data() + id * this->_dimension;
+        for (unsigned d = 0; d < this->_dimension; ++d) {
+            this->updateParameter(id * this->_dimension + d, gradient[d]);
+            gradient[d] = 0.0;
+        }
+    }
+    // Ids are not differentiable, _inputGradients stays at 0
+}
+
+Neural::ITransformLayer *Neural::EmbeddingLayer::clone() const {
+    return new EmbeddingLayer(*this);
+}
@@ -0,0 +1,100 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   06/05/2018 17:05:33
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 06/05/2018 19:47:10
+ */
+
+
+#include "GraphNetwork.hpp"
+
+Neural::GraphNetwork::GraphNetwork(Network const &network, bool fused): _network(network), _graph(network) {
+    this->_fused = fused;
+    this->_normalized = false;
+    this->_dirty = false;
+    if (this->_fused)
+        this->_graph.fuse();
+}
+
+Neural::GraphNetwork::GraphNetwork(Network const &network, std::vector<double> const &inputMean, std::vector<double> const &inputDeviation, bool fused): _network(network), _graph(network, inputMean, inputDeviation) {
+    this->_fused = fused;
+    this->_normalized = true;
+    this->_dirty = false;
+    this->_inputMean = inputMean;
+    this->_inputDeviation = inputDeviation;
+    if (this->_fused)
+        this->_graph.fuse();
+}
+
+Neural::GraphNetwork::~GraphNetwork() {
+
+}
+
+Neural::GraphNetwork::GraphNetwork(const GraphNetwork &network): _network(network._network), _graph(network._graph) {
+    this->_fused = network._fused;
+    this->_normalized = network._normalized;
+    this->_dirty = network._dirty;
+    this->_inputMean = network._inputMean;
+    this->_inputDeviation = network._inputDeviation;
+}
+
+Neural::GraphNetwork &Neural::GraphNetwork::operator =(const GraphNetwork &network) {
+    this->_network = network._network;
+    this->_graph = network._graph;
+    this->_fused = network._fused;
+    this->_normalized = network._normalized;
+    this->_dirty = network._dirty;
+    this->_inputMean = network._inputMean;
+    this->_inputDeviation = network._inputDeviation;
+    return *this;
+}
+
+void Neural::GraphNetwork::train(INetworkTrainer const &trainer) {
+    this->_network.train(trainer);
+    this->_dirty = true;
+}
+
+void Neural::GraphNetwork::feedForward(const std::vector<double> &inputVals) {
+    if (this->_dirty)
+        this->rebuild();
+    this->_graph.execute(inputVals, this->_results, this->_scratch);
+    this->_lastInput = inputVals;
+}
+
+std::vector<double> const Neural::GraphNetwork::getResults() const {
+    return this->_results;
+}
+
+void Neural::GraphNetwork::backProp(const std::vector<double> &targetVals) {
+    // The graph keeps no per neuron state, replay the last input through the network
+    this->_network.feedForward(this->_lastInput);
+    this->_network.backProp(targetVals);
+    this->_dirty = true;
+}
+
+void Neural::GraphNetwork::errorPlot() const {
+    this->_network.errorPlot();
+}
+
+void Neural::GraphNetwork::dump(std::ostream &os) const {
+    this->_graph.dump(os);
+}
+
+Neural::Network const &Neural::GraphNetwork::getNetwork() const {
+    return this->_network;
+}
+
+Neural::OperatorGraph const &Neural::GraphNetwork::getGraph() const {
+    return this->_graph;
+}
+
+void Neural::GraphNetwork::rebuild() {
+    if (this->_normalized)
+        this->_graph = OperatorGraph(this->_network, this->_inputMean, this->_inputDeviation);
+    else
+        this->_graph = OperatorGraph(this->_network);
+    if (this->_fused)
+        this->_graph.fuse();
+    this->_dirty = false;
+}
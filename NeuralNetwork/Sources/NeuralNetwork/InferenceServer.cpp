@@ -0,0 +1,383 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   19/05/2018 10:33:18
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 19/05/2018 21:05:52
+ */
+
+
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <limits>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "InferenceServer.hpp"
+
+// Answers kept for a client that does not read them, past that its requests are not read either
+static const size_t MaxUnsent = 1 << 20;
+
+Neural::InferenceServer::Options::Options(unsigned maxBatch, unsigned maxLatency, unsigned threads) {
+    this->maxBatch = maxBatch;
+    this->maxLatency = maxLatency;
+    this->threads = threads;
+}
+
+Neural::InferenceServer::Connection::Connection(int fd) {
+    this->fd = fd;
+    this->sequence = 0;
+    this->sent = 0;
+}
+
+Neural::InferenceServer::Connection::~Connection() {
+    close(this->fd);
+}
+
+Neural::InferenceServer::InferenceServer(Network const &network, Options const &options): _network(network) {
+    this->_options = options;
+    this->_options.maxBatch = std::max(1u, options.maxBatch);
+    if (network.getTransforms().empty()) {
+        this->_graph.reset(new OperatorGraph(network));
+        this->_graph->fuse();
+    }
+    this->_server = -1;
+    this->_wake[0] = this->_wake[1] = -1;
+    this->_stop = false;
+    this->_busy = 0;
+    this->_requests = 0;
+    this->_batches = 0;
+    for (auto &latency: this->_latencies) {
+        latency = 0;
+    }
+}
+
+Neural::InferenceServer::~InferenceServer() {
+    if (this->_server >= 0) {
+        close(this->_server);
+        if (this->_address.find('/') != std::string::npos)
+            unlink(this->_address.c_str());
+    }
+    for (int fd: this->_wake) {
+        if (fd >= 0)
+            close(fd);
+    }
+}
+
+void Neural::InferenceServer::listen(std::string const &address) {
+    if (address.find('/') != std::string::npos) {
+        sockaddr_un local;
+        if (address.size() >= sizeof(local.sun_path))
+            throw Neural::NetworkException("The socket path " + address + " is too long");
+        memset(&local, 0, sizeof(local));
+        local.sun_family = AF_UNIX;
+        strcpy(local.sun_path, address.c_str());
+        this->_server = socket(AF_UNIX, SOCK_STREAM, 0);
+        unlink(address.c_str());
+        if (this->_server < 0 || bind(this->_server, reinterpret_cast<sockaddr *>(&local), sizeof(local)) < 0)
+            throw Neural::NetworkException("Could not bind " + address + ": " + strerror(errno));
+    } else {
+        size_t colon = address.rfind(':');
+        std::string host = colon == std::string::npos ? "" : address.substr(0, colon);
+        std::string port = colon == std::string::npos ? address : address.substr(colon + 1);
+        addrinfo hints;
+        addrinfo *result = nullptr;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_PASSIVE;
+        if (getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &result) != 0 || result == nullptr)
+            throw Neural::NetworkException("Could not resolve " + address);
+        this->_server = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+        int yes = 1;
+        setsockopt(this->_server, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+        bool bound = this->_server >= 0 && bind(this->_server, result->ai_addr, result->ai_addrlen) == 0;
+        freeaddrinfo(result);
+        if (!bound)
+            throw Neural::NetworkException("Could not bind " + address + ": " + strerror(errno));
+    }
+    if (::listen(this->_server, 128) < 0)
+        throw Neural::NetworkException("Could not listen on " + address + ": " + strerror(errno));
+    if (pipe(this->_wake) < 0)
+        throw Neural::NetworkException("Could not create the wake up pipe: " + std::string(strerror(errno)));
+    // A full pipe already wakes the poll loop up, the workers must not wait on it
+    for (int fd: this->_wake) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+    this->_address = address;
+}
+
+void Neural::InferenceServer::run() {
+    if (this->_server < 0)
+        throw Neural::NetworkException("The server must listen before it runs");
+
+    this->_pool.reset(new ThreadPool(this->_options.threads));
+    std::thread batcher(&InferenceServer::batch, this);
+    std::vector<std::shared_ptr<Connection>> connections;
+    std::vector<std::shared_ptr<Connection>> closed;
+    std::vector<pollfd> fds;
+
+    while (!this->_stop) {
+        fds.assign({{this->_wake[0], POLLIN, 0}, {this->_server, POLLIN, 0}});
+        for (auto const &connection: connections) {
+            std::lock_guard<std::mutex> lock(connection->mutex);
+            short events = connection->unsent.size() < MaxUnsent ? POLLIN : 0;
+            fds.push_back({connection->fd, (short)(events | (connection->unsent.empty() ? 0 : POLLOUT)), 0});
+        }
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            throw Neural::NetworkException("Could not poll the connections: " + std::string(strerror(errno)));
+        }
+        if (fds[0].revents & POLLIN) {
+            char wake[64];
+            while (::read(this->_wake[0], wake, sizeof(wake)) > 0);
+        }
+        if (fds[1].revents & POLLIN) {
+            int fd = accept(this->_server, nullptr, nullptr);
+            if (fd >= 0) {
+                // Answers are small, they must not wait for Nagle
+                int yes = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+                // A client that does not read must not hold the workers answering it
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+                connections.push_back(std::make_shared<Connection>(fd));
+            }
+        }
+        closed.clear();
+        for (unsigned n = 2; n < fds.size(); ++n) {
+            if (fds[n].revents & POLLOUT) {
+                std::lock_guard<std::mutex> lock(connections[n - 2]->mutex);
+                this->flush(*connections[n - 2]);
+            }
+            if (fds[n].revents & (POLLIN | POLLHUP | POLLERR))
+                this->read(connections[n - 2], closed);
+        }
+        // The pending requests of a closed connection keep it alive until they are answered
+        for (auto const &connection: closed) {
+            connections.erase(std::find(connections.begin(), connections.end(), connection));
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_queued.notify_all();
+        this->_idle.notify_all();
+    }
+    batcher.join();
+    this->_pool.reset();
+}
+
+void Neural::InferenceServer::stop() {
+    this->_stop = true;
+    if (this->_wake[1] >= 0 && write(this->_wake[1], "", 1) < 0) {
+        // The poll loop sees the flag on its next wake up anyway
+    }
+}
+
+void Neural::InferenceServer::read(std::shared_ptr<Connection> const &connection, std::vector<std::shared_ptr<Connection>> &closed) {
+    char buffer[1 << 16];
+    ssize_t count = recv(connection->fd, buffer, sizeof(buffer), 0);
+
+    if (count <= 0) {
+        if (count < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK))
+            return;
+        closed.push_back(connection);
+        return;
+    }
+    connection->received.append(buffer, count);
+    size_t begin = 0;
+    size_t newline;
+    while ((newline = connection->received.find('\n', begin)) != std::string::npos) {
+        this->request(connection, connection->received.substr(begin, newline - begin));
+        begin = newline + 1;
+    }
+    connection->received.erase(0, begin);
+}
+
+void Neural::InferenceServer::request(std::shared_ptr<Connection> const &connection, std::string const &line) {
+    std::stringstream ss(line);
+    std::string label;
+
+    if (!(ss >> label))
+        return;
+    uint64_t sequence = connection->sequence++;
+    if (label == "stats:") {
+        Stats stats = this->getStats();
+        std::ostringstream os;
+        os << "stats: requests " << stats.requests << " batches " << stats.batches << " p50 " << stats.p50 << " p99 " << stats.p99 << "\n";
+        this->answer(*connection, sequence, os.str());
+        return;
+    }
+    if (label != "in:") {
+        this->answer(*connection, sequence, "error: unknown request " + label + "\n");
+        return;
+    }
+
+    Request request{connection, sequence, {}, std::chrono::steady_clock::now()};
+    double oneValue;
+    while (ss >> oneValue) {
+        request.input.push_back(oneValue);
+    }
+    if (request.input.size() != this->_network.getInputCount()) {
+        this->answer(*connection, sequence, "error: " + std::to_string(request.input.size()) + " inputs given, the network takes " + std::to_string(this->_network.getInputCount()) + "\n");
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    this->_queue.push_back(std::move(request));
+    if (this->_queue.size() == 1 || this->_queue.size() >= this->_options.maxBatch)
+        this->_queued.notify_one();
+}
+
+void Neural::InferenceServer::batch() {
+    std::chrono::microseconds latency(this->_options.maxLatency);
+    std::unique_lock<std::mutex> lock(this->_mutex);
+
+    while (true) {
+        this->_queued.wait(lock, [this]() { return this->_stop || !this->_queue.empty(); });
+        if (this->_stop)
+            return;
+        // The oldest request sets the deadline, a full batch leaves at once
+        auto deadline = this->_queue.front().arrival + latency;
+        this->_queued.wait_until(lock, deadline, [this]() { return this->_stop || this->_queue.size() >= this->_options.maxBatch; });
+        this->_idle.wait(lock, [this]() { return this->_stop || this->_busy < this->_pool->getThreadCount(); });
+        if (this->_stop)
+            return;
+
+        unsigned count = std::min<size_t>(this->_queue.size(), this->_options.maxBatch);
+        auto batch = std::make_shared<std::vector<Request>>(std::make_move_iterator(this->_queue.begin()), std::make_move_iterator(this->_queue.begin() + count));
+        this->_queue.erase(this->_queue.begin(), this->_queue.begin() + count);
+        this->_busy++;
+        lock.unlock();
+        this->_pool->submit([this, batch]() {
+            this->process(*batch);
+            std::lock_guard<std::mutex> done(this->_mutex);
+            this->_busy--;
+            this->_idle.notify_one();
+        });
+        lock.lock();
+    }
+}
+
+void Neural::InferenceServer::process(std::vector<Request> &batch) {
+    // Buffers of the worker, reused by all its batches
+    thread_local std::vector<double> inputs;
+    thread_local std::vector<double> outputs;
+    thread_local std::vector<double> scratch;
+    thread_local Workspace workspace;
+    std::vector<std::string> answers(batch.size());
+
+    if (this->_graph) {
+        unsigned inputCount = this->_graph->getInputCount();
+        unsigned outputCount = this->_graph->getOutputCount();
+        inputs.resize(batch.size() * inputCount);
+        for (unsigned b = 0; b < batch.size(); ++b) {
+            std::copy(batch[b].input.begin(), batch[b].input.end(), inputs.begin() + b * inputCount);
+        }
+        this->_graph->executeBatch(inputs, batch.size(), outputs, scratch);
+        for (unsigned b = 0; b < batch.size(); ++b) {
+            std::ostringstream os;
+            os.precision(std::numeric_limits<double>::max_digits10);
+            os << "out:";
+            for (unsigned o = 0; o < outputCount; ++o) {
+                os << " " << outputs[b * outputCount + o];
+            }
+            answers[b] = os.str() + "\n";
+        }
+    } else {
+        for (unsigned b = 0; b < batch.size(); ++b) {
+            try {
+                std::vector<double> const &output = this->_network.predict(batch[b].input, workspace);
+                std::ostringstream os;
+                os.precision(std::numeric_limits<double>::max_digits10);
+                os << "out:";
+                for (double value: output) {
+                    os << " " << value;
+                }
+                answers[b] = os.str() + "\n";
+            } catch (Neural::InvalidInput const &error) {
+                answers[b] = std::string("error: ") + error.what() + "\n";
+            }
+        }
+    }
+
+    for (unsigned b = 0; b < batch.size(); ++b) {
+        this->answer(*batch[b].connection, batch[b].sequence, answers[b]);
+        this->record(batch[b].arrival);
+    }
+    this->_requests += batch.size();
+    this->_batches++;
+}
+
+void Neural::InferenceServer::answer(Connection &connection, uint64_t sequence, std::string const &text) {
+    std::lock_guard<std::mutex> lock(connection.mutex);
+    connection.ready[sequence] = text;
+
+    // Write every answer that is now in order, what the socket does not take waits for the poll thread
+    auto it = connection.ready.begin();
+    while (it != connection.ready.end() && it->first == connection.sent) {
+        connection.unsent += it->second;
+        it = connection.ready.erase(it);
+        connection.sent++;
+    }
+    this->flush(connection);
+    if (connection.unsent.empty())
+        return;
+    if (write(this->_wake[1], "", 1) < 0) {
+        // The pipe is full, the poll loop is woken up already
+    }
+}
+
+// The caller holds the lock of the connection, a client that left is ignored
+void Neural::InferenceServer::flush(Connection &connection) {
+    size_t written = 0;
+    while (written < connection.unsent.size()) {
+        ssize_t count = send(connection.fd, connection.unsent.data() + written, connection.unsent.size() - written, MSG_NOSIGNAL);
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        if (count <= 0) {
+            written = connection.unsent.size();
+            break;
+        }
+        written += count;
+    }
+    connection.unsent.erase(0, written);
+}
+
+void Neural::InferenceServer::record(std::chrono::steady_clock::time_point arrival) {
+    double microseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - arrival).count();
+    unsigned bucket = std::min(255.0, 8.0 * log2(1.0 + microseconds));
+    this->_latencies[bucket]++;
+}
+
+double Neural::InferenceServer::percentile(double rank) const {
+    uint64_t total = 0;
+    for (auto const &latency: this->_latencies) {
+        total += latency;
+    }
+    uint64_t seen = 0;
+    for (unsigned bucket = 0; bucket < this->_latencies.size(); ++bucket) {
+        seen += this->_latencies[bucket];
+        if (total != 0 && seen >= rank * total)
+            return exp2((bucket + 1) / 8.0) - 1.0; // upper bound of the bucket
+    }
+    return 0.0;
+}
+
+Neural::InferenceServer::Stats Neural::InferenceServer::getStats() const {
+    return Stats{this->_requests, this->_batches, this->percentile(0.5), this->percentile(0.99)};
+}
+
+std::string const &Neural::InferenceServer::getAddress() const {
+    return this->_address;
+}
@@ -0,0 +1,65 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   14/05/2018 11:27:40
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 14/05/2018 17:48:31
+ */
+
+
+#include "Initializer.hpp"
+
+Neural::Initializer::Initializer(Scheme scheme, uint64_t seed) {
+    this->_scheme = scheme;
+    this->_seed = seed;
+}
+
+Neural::Initializer::~Initializer() {
+
+}
+
+Neural::Initializer::Initializer(const Initializer &initializer) {
+    this->_scheme = initializer._scheme;
+    this->_seed = initializer._seed;
+}
+
+Neural::Initializer &Neural::Initializer::operator =(const Initializer &initializer) {
+    this->_scheme = initializer._scheme;
+    this->_seed = initializer._seed;
+    return *this;
+}
+
+Neural::Initializer::Scheme Neural::Initializer::getScheme() const {
+    return this->_scheme;
+}
+
+uint64_t Neural::Initializer::getSeed() const {
+    return this->_seed;
+}
+
+double Neural::Initializer::weight(Random &random, unsigned fanIn, unsigned fanOut) const {
+    switch (this->_scheme) {
+    case Xavier: {
+        double limit = sqrt(6.0 / (fanIn + fanOut));
+        return random.uniform(-limit, limit);
+    }
+    case He:
+        return random.normal() * sqrt(2.0 / fanIn);
+    default:
+        return random.uniform();
+    }
+}
+
+double Neural::Initializer::bias(Random &random) const {
+    return this->_scheme == Uniform ? random.uniform() : 0.0;
+}
+
+Neural::Initializer::Scheme Neural::Initializer::parse(std::string const &name) {
+    if (name == "uniform")
+        return Uniform;
+    if (name == "xavier")
+        return Xavier;
+    if (name == "he")
+        return He;
+    throw Neural::NetworkException("Unknown initialization " + name + ", expected uniform, xavier or he");
+}
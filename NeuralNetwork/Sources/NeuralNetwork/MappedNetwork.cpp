@@ -0,0 +1,103 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   20/05/2018 16:04:51
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 20/05/2018 19:41:27
+ */
+
+
+#include "MappedNetwork.hpp"
+
+Neural::MappedNetwork::MappedNetwork(std::string const &path, bool verify): _file(path, verify) {
+    this->_topology = this->_file.getTopology();
+    if (!this->_topology.getTransforms().empty())
+        throw Neural::InvalidSavingFile("The model " + path + " has transform layers, only fully connected models can be mapped");
+
+    std::vector<unsigned> const &layers = this->_topology.getLayers();
+    this->_weights.push_back(nullptr);
+    this->_batchNorms.emplace_back();
+    for (unsigned layerNum = 1; layerNum < layers.size(); ++layerNum) {
+        uint64_t count;
+        this->_decoded.emplace_back();
+        const double *weights = this->_file.getBlock(ModelFile::DenseWeights, layerNum, count, this->_decoded.back());
+        if (weights == nullptr || count != (uint64_t)layers[layerNum] * (layers[layerNum - 1] + 1))
+            throw Neural::InvalidSavingFile("The model " + path + " does not hold the weights of the layer " + std::to_string(layerNum));
+        this->_weights.push_back(weights);
+
+        // Only a few values per neuron, kept as objects so that the arithmetic is the one of the network
+        this->_batchNorms.emplace_back();
+        if (!this->_topology.getBatchNorm()[layerNum])
+            continue;
+        std::vector<double> storage;
+        const double *state = this->_file.getBlock(ModelFile::BatchNormState, layerNum, count, storage);
+        if (state == nullptr || count != (uint64_t)layers[layerNum] * 6)
+            throw Neural::InvalidSavingFile("The model " + path + " does not hold the batch normalization of the layer " + std::to_string(layerNum));
+        for (unsigned n = 0; n < layers[layerNum]; ++n, state += 6) {
+            this->_batchNorms.back().emplace_back();
+            this->_batchNorms.back().back().setState(INeuron::Connection{state[0], state[1]}, INeuron::Connection{state[2], state[3]}, state[4], state[5]);
+        }
+    }
+}
+
+Neural::MappedNetwork::~MappedNetwork() {
+
+}
+
+void Neural::MappedNetwork::predict(const std::vector<double> &input, std::vector<double> &output, std::vector<double> &scratch) const {
+    std::vector<unsigned> const &layers = this->_topology.getLayers();
+    if (input.size() != this->getInputCount()) {
+        throw Neural::InvalidInput("You want to input " + std::to_string(input.size()) + " values but your network can only accept " + std::to_string(this->getInputCount()));
+    }
+
+    // Ping-pong between scratch and output, the sums are the ones of Network::predict
+    unsigned width = *std::max_element(layers.begin(), layers.end());
+    output.resize(width);
+    scratch.resize(width);
+    double *buffers[2] = {output.data(), scratch.data()};
+    const double *source = input.data();
+    unsigned last = layers.size() - 1;
+    bool softmax = this->_topology.getLoss() == Topology::SoftmaxCrossEntropy;
+    for (unsigned layerNum = 1; layerNum <= last; ++layerNum) {
+        double *destination = buffers[(last - layerNum) & 1];
+        unsigned inputs = layers[layerNum - 1];
+        std::vector<BatchNorm> const &batchNorms = this->_batchNorms[layerNum];
+        for (unsigned o = 0; o < layers[layerNum]; ++o) {
+            const double *row = this->_weights[layerNum] + (size_t)o * (inputs + 1);
+            double sum = 0.0;
+            for (unsigned i = 0; i < inputs; ++i) {
+                sum += source[i] * row[i];
+            }
+            sum += 1.0 * row[inputs];
+            if (!batchNorms.empty())
+                sum = batchNorms[o].infer(sum);
+            destination[o] = softmax && layerNum == last ? sum : tanh(sum);
+        }
+        source = destination;
+    }
+    output.resize(layers.back());
+
+    if (softmax) {
+        double max = *std::max_element(output.begin(), output.end());
+        double sum = 0.0;
+        for (double value: output) {
+            sum += exp(value - max);
+        }
+        double logSum = max + log(sum);
+        for (double &value: output) {
+            value = exp(value - logSum);
+        }
+    }
+}
+
+Neural::Topology const &Neural::MappedNetwork::getTopology() const {
+    return this->_topology;
+}
+
+unsigned Neural::MappedNetwork::getInputCount() const {
+    return this->_topology.getInputCount();
+}
+
+unsigned Neural::MappedNetwork::getOutputCount() const {
+    return this->_topology.getOutputCount();
+}
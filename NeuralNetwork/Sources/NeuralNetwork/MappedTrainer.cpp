@@ -0,0 +1,88 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   23/05/2018 14:31:08
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 23/05/2018 18:12:50
+ */
+
+
+#include <numeric>
+
+#include "MappedTrainer.hpp"
+
+class Neural::MappedTrainer::Reader : public INetworkTrainer::IReader {
+
+public:
+    Reader(MappedTrainer const &trainer): _trainer(trainer) {
+        this->_next = 0;
+    }
+
+    const TrainingData *next() {
+        if (this->_next == this->_trainer._file->getSampleCount())
+            return nullptr;
+        uint64_t index = this->_trainer._order.empty() ? this->_next : this->_trainer._order[this->_next];
+        this->_trainer._file->getSample(index, this->_data.input, this->_data.output);
+        this->_next++;
+        return &this->_data;
+    }
+
+private:
+    MappedTrainer const &_trainer;
+    uint64_t _next;
+    TrainingData _data;
+
+};
+
+Neural::MappedTrainer::MappedTrainer(std::string const &filename) {
+    this->_debug = false;
+    this->_file.reset(new DatasetFile(filename));
+    this->_topology = Topology(this->_file->getTopologyBrief());
+}
+
+Neural::MappedTrainer::~MappedTrainer() {
+
+}
+
+Neural::MappedTrainer::MappedTrainer(const MappedTrainer &trainer) {
+    *this = trainer;
+}
+
+Neural::MappedTrainer &Neural::MappedTrainer::operator =(const MappedTrainer &trainer) {
+    this->_debug = trainer._debug;
+    this->_file = trainer._file;
+    this->_topology = trainer._topology;
+    this->_order = trainer._order;
+    return *this;
+}
+
+Neural::Topology const &Neural::MappedTrainer::getTopology() const {
+    return this->_topology;
+}
+
+std::unique_ptr<Neural::INetworkTrainer::IReader> Neural::MappedTrainer::read() const {
+    return std::unique_ptr<IReader>(new Reader(*this));
+}
+
+size_t Neural::MappedTrainer::getSampleCount() const {
+    return this->_file->getSampleCount();
+}
+
+void Neural::MappedTrainer::shuffle(Random &random) {
+    if (this->_order.empty()) {
+        this->_order.resize(this->_file->getSampleCount());
+        std::iota(this->_order.begin(), this->_order.end(), 0);
+    }
+    // Fisher-Yates
+    for (unsigned n = this->_order.size(); n > 1; --n) {
+        std::swap(this->_order[n - 1], this->_order[random.below(n)]);
+    }
+}
+
+void Neural::MappedTrainer::setDebugFLag(bool mode) {
+    this->_debug = mode;
+}
+
+bool Neural::MappedTrainer::getDebugFLag() const {
+    return this->_debug;
+}
@@ -0,0 +1,311 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   20/05/2018 11:12:40
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 20/05/2018 19:38:02
+ */
+
+
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "ModelFile.hpp"
+
+static const char Magic[8] = {'D', 'N', 'N', 'M', 'O', 'D', 'E', 'L'};
+static const uint32_t ByteOrder = 0x01020304;
+
+Neural::ModelFile::ModelFile(std::string const &path, bool verify) {
+    this->_path = path;
+    this->_data = nullptr;
+    this->_size = 0;
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw Neural::InvalidSavingFile("Your model file " + path + " could not be opened: " + strerror(errno));
+    struct stat status;
+    if (fstat(fd, &status) < 0 || (size_t)status.st_size < sizeof(Header)) {
+        close(fd);
+        throw Neural::InvalidSavingFile("Your model file " + path + " is too small to be a model");
+    }
+    this->_size = status.st_size;
+    void *data = mmap(nullptr, this->_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        throw Neural::InvalidSavingFile("Your model file " + path + " could not be mapped: " + strerror(errno));
+    this->_data = static_cast<const unsigned char *>(data);
+    this->_header = reinterpret_cast<const Header *>(this->_data);
+
+    std::string error;
+    uint32_t version = this->_header->version;
+    uint64_t tableOffset = align(sizeof(Header) + (uint64_t)this->_header->topologySize);
+    uint64_t entrySize = version == 1 ? sizeof(TableEntryV1) : sizeof(TableEntry);
+    if (memcmp(this->_header->magic, Magic, sizeof(Magic)) != 0)
+        error = "is not a model file";
+    else if (version != 1 && version != Version)
+        error = "has the version " + std::to_string(version) + ", only the versions 1 to " + std::to_string(Version) + " are supported";
+    else if (this->_header->byteOrder != ByteOrder)
+        error = "was written with another byte order";
+    else if (this->_header->fileSize != this->_size)
+        error = "is truncated";
+    else if (tableOffset + (uint64_t)this->_header->blockCount * entrySize > this->_size)
+        error = "has a block table out of the file";
+    else if (verify && checksum(0, this->_data + sizeof(Header), this->_size - sizeof(Header)) != this->_header->checksum)
+        error = "is corrupted, its checksum does not match";
+    for (unsigned n = 0; error.empty() && n < this->_header->blockCount; ++n) {
+        TableEntry entry{};
+        if (version == 1) {
+            TableEntryV1 old;
+            memcpy(&old, this->_data + tableOffset + n * entrySize, sizeof(old));
+            entry = TableEntry{old.kind, old.index, old.offset, old.count, Float64, 0};
+        } else {
+            memcpy(&entry, this->_data + tableOffset + n * entrySize, sizeof(entry));
+        }
+        if (entry.precision > BFloat16)
+            error = "has a block of an unknown precision";
+        else if (entry.offset % 64 != 0 || entry.offset > this->_size || entry.count > (this->_size - entry.offset) / elementSize(entry.precision))
+            error = "has a block out of the file";
+        this->_table.push_back(entry);
+    }
+    if (!error.empty()) {
+        munmap(const_cast<unsigned char *>(this->_data), this->_size);
+        throw Neural::InvalidSavingFile("Your model file " + path + " " + error);
+    }
+}
+
+Neural::ModelFile::~ModelFile() {
+    munmap(const_cast<unsigned char *>(this->_data), this->_size);
+}
+
+void Neural::ModelFile::write(std::string const &path, Content const &content) {
+    std::vector<Block> const &blocks = content.blocks;
+    std::ofstream file(path.c_str(), std::ios::binary);
+    if (!file)
+        throw Neural::InvalidSavingFile("The model file " + path + " could not be created");
+
+    std::string brief = content.topology.toString();
+    auto precision = [&content](Block const &block) {
+        return block.kind == TrainingState || block.kind == ErrorHistory ? Float64 : content.precision;
+    };
+    Header header{};
+    memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.byteOrder = ByteOrder;
+    header.topologySize = brief.size();
+    header.blockCount = blocks.size();
+    header.error = content.error;
+    header.recentAverageError = content.recentAverageError;
+    header.smoothing = content.smoothing;
+
+    // Every section is padded to 64 bytes, the checksum reads whole 8 bytes words
+    std::vector<TableEntry> table;
+    uint64_t offset = align(align(sizeof(Header) + brief.size()) + blocks.size() * sizeof(TableEntry));
+    for (auto const &block: blocks) {
+        table.push_back(TableEntry{(uint32_t)block.kind, block.index, offset, block.values.size(), (uint32_t)precision(block), 0});
+        offset = align(offset + block.values.size() * elementSize(precision(block)));
+    }
+    header.fileSize = offset;
+
+    uint64_t hash = 0;
+    uint64_t written = sizeof(Header);
+    std::vector<char> padding(64, 0);
+    auto emit = [&](const void *data, size_t size) {
+        hash = checksum(hash, data, size);
+        file.write(static_cast<const char *>(data), size);
+        written += size;
+    };
+    auto pad = [&]() {
+        emit(padding.data(), align(written) - written);
+    };
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    std::vector<char> topologyBytes(brief.begin(), brief.end());
+    topologyBytes.resize(align(sizeof(Header) + brief.size()) - sizeof(Header), 0);
+    emit(topologyBytes.data(), topologyBytes.size());
+    emit(table.data(), table.size() * sizeof(TableEntry));
+    pad();
+    std::vector<unsigned char> encoded;
+    for (auto const &block: blocks) {
+        if (precision(block) == Float64) {
+            emit(block.values.data(), block.values.size() * sizeof(double));
+        } else {
+            // Rounded up to whole words, the checksum reads nothing else
+            encoded.assign((block.values.size() * elementSize(precision(block)) + 7) & ~(size_t)7, 0);
+            encode(block.values, precision(block), encoded.data());
+            emit(encoded.data(), encoded.size());
+        }
+        pad();
+    }
+    header.checksum = hash;
+    file.seekp(0);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    if (!file)
+        throw Neural::InvalidSavingFile("The model file " + path + " could not be written");
+}
+
+bool Neural::ModelFile::isModelFile(std::string const &path) {
+    std::ifstream file(path.c_str(), std::ios::binary);
+    char magic[sizeof(Magic)];
+
+    return file.read(magic, sizeof(magic)) && memcmp(magic, Magic, sizeof(Magic)) == 0;
+}
+
+Neural::ModelFile::Precision Neural::ModelFile::parsePrecision(std::string const &name) {
+    if (name == "float64")
+        return Float64;
+    if (name == "float32")
+        return Float32;
+    if (name == "float16")
+        return Float16;
+    if (name == "bfloat16")
+        return BFloat16;
+    throw Neural::NetworkException("Unknown precision " + name + ", expected float64, float32, float16 or bfloat16");
+}
+
+Neural::Topology Neural::ModelFile::getTopology() const {
+    return Topology(std::string(reinterpret_cast<const char *>(this->_data + sizeof(Header)), this->_header->topologySize));
+}
+
+double Neural::ModelFile::getError() const {
+    return this->_header->error;
+}
+
+double Neural::ModelFile::getRecentAverageError() const {
+    return this->_header->recentAverageError;
+}
+
+double Neural::ModelFile::getSmoothing() const {
+    return this->_header->smoothing;
+}
+
+const double *Neural::ModelFile::getBlock(BlockKind kind, unsigned index, uint64_t &count, std::vector<double> &storage) const {
+    for (auto const &entry: this->_table) {
+        if (entry.kind == (uint32_t)kind && entry.index == index) {
+            count = entry.count;
+            if (entry.precision == Float64)
+                return reinterpret_cast<const double *>(this->_data + entry.offset);
+            storage.resize(count);
+            decode(this->_data + entry.offset, (Precision)entry.precision, count, storage.data());
+            return storage.data();
+        }
+    }
+    count = 0;
+    return nullptr;
+}
+
+uint64_t Neural::ModelFile::align(uint64_t offset) {
+    return (offset + 63) & ~(uint64_t)63;
+}
+
+uint64_t Neural::ModelFile::elementSize(uint32_t precision) {
+    static const uint64_t sizes[] = {sizeof(double), sizeof(float), sizeof(uint16_t), sizeof(uint16_t)};
+    return sizes[precision];
+}
+
+// Both halves round to nearest even, from the float the double was first rounded to
+static uint16_t toHalf(float value) {
+    uint32_t x;
+    memcpy(&x, &value, sizeof(x));
+    uint16_t sign = (x >> 16) & 0x8000;
+    uint32_t mantissa = x & 0x7FFFFF;
+    int exponent = (int)((x >> 23) & 0xFF) - 127 + 15;
+
+    if (((x >> 23) & 0xFF) == 0xFF)
+        return sign | 0x7C00 | (mantissa ? 0x200 : 0);
+    if (exponent >= 31)
+        return sign | 0x7C00;
+    // Subnormal halves keep the top bits of the mantissa with its implicit one
+    unsigned shift = 13;
+    uint32_t half = (uint32_t)exponent << 10 | mantissa >> 13;
+    if (exponent <= 0) {
+        if (exponent < -10)
+            return sign;
+        mantissa |= 0x800000;
+        shift = 14 - exponent;
+        half = mantissa >> shift;
+    }
+    uint32_t rest = mantissa & ((1u << shift) - 1);
+    uint32_t halfway = 1u << (shift - 1);
+    if (rest > halfway || (rest == halfway && (half & 1)))
+        half++;
+    return sign | half;
+}
+
+static float fromHalf(uint16_t half) {
+    uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1F;
+    uint32_t mantissa = half & 0x3FF;
+    uint32_t x;
+
+    if (exponent == 0) {
+        float value = std::ldexp((float)mantissa, -24);
+        return sign ? -value : value;
+    }
+    if (exponent == 0x1F)
+        x = sign | 0x7F800000 | mantissa << 13;
+    else
+        x = sign | (exponent + 112) << 23 | mantissa << 13;
+    float value;
+    memcpy(&value, &x, sizeof(value));
+    return value;
+}
+
+static uint16_t toBFloat16(float value) {
+    uint32_t x;
+    memcpy(&x, &value, sizeof(x));
+    if ((x & 0x7FFFFFFF) > 0x7F800000)
+        return (x >> 16) | 0x40;
+    x += 0x7FFF + ((x >> 16) & 1);
+    return x >> 16;
+}
+
+static float fromBFloat16(uint16_t bits) {
+    uint32_t x = (uint32_t)bits << 16;
+    float value;
+    memcpy(&value, &x, sizeof(value));
+    return value;
+}
+
+void Neural::ModelFile::encode(std::vector<double> const &values, Precision precision, unsigned char *data) {
+    for (size_t n = 0; n < values.size(); ++n) {
+        float value = (float)values[n];
+        if (precision == Float32) {
+            memcpy(data + n * sizeof(value), &value, sizeof(value));
+        } else {
+            uint16_t bits = precision == Float16 ? toHalf(value) : toBFloat16(value);
+            memcpy(data + n * sizeof(bits), &bits, sizeof(bits));
+        }
+    }
+}
+
+void Neural::ModelFile::decode(const unsigned char *data, Precision precision, uint64_t count, double *values) {
+    for (uint64_t n = 0; n < count; ++n) {
+        float value;
+        uint16_t bits;
+        if (precision == Float32) {
+            memcpy(&value, data + n * sizeof(value), sizeof(value));
+        } else {
+            memcpy(&bits, data + n * sizeof(bits), sizeof(bits));
+            value = precision == Float16 ? fromHalf(bits) : fromBFloat16(bits);
+        }
+        values[n] = value;
+    }
+}
+
+uint64_t Neural::ModelFile::checksum(uint64_t hash, const void *data, size_t size) {
+    // One multiply and rotate per word, only meant to catch truncated or damaged files
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for (size_t n = 0; n + 8 <= size; n += 8) {
+        uint64_t word;
+        memcpy(&word, bytes + n, sizeof(word));
+        hash ^= word * 0x9E3779B97F4A7C15ull;
+        hash = ((hash << 27) | (hash >> 37)) * 0xC2B2AE3D27D4EB4Full;
+    }
+    return hash;
+}
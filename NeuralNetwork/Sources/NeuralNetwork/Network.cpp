@@ -7,10 +7,24 @@
  */
 
 
-#include "Network.hpp"
+#include <cstring>
 
-Neural::Network::Network(const std::vector<unsigned> &topology, double recentAverageSmoothingFactor): ANetworkData(topology, recentAverageSmoothingFactor) {
+#include "Network.hpp"
+#include "SnapshotPublisher.hpp"
+#include "SampleStream.hpp"
+#include "Checkpointer.hpp"
 
+Neural::Network::Network(const Topology &topology, double recentAverageSmoothingFactor, Initializer const &initializer): ANetworkData(topology, recentAverageSmoothingFactor, initializer) {
+    this->_training = false;
+    this->_dropoutStep = 0;
+    this->_epoch = 0;
+    this->_position = 0;
+    this->_publisher = nullptr;
+    this->_publishInterval = 1000;
+    this->_checkpointer = nullptr;
+    this->_historyLimit = 0;
+    this->_historyStride = 1;
+    this->_historySkipped = 0;
 }
 
 Neural::Network::~Network() {
@@ -18,19 +32,48 @@ Neural::Network::~Network() {
 }
 
 Neural::Network::Network(const Neural::Network &network) : ANetworkData(network) {
-
+    this->_training = network._training;
+    this->_dropoutStep = network._dropoutStep;
+    this->_epoch = network._epoch;
+    this->_position = network._position;
+    this->_errorHistory = network._errorHistory;
+    this->_publisher = nullptr;
+    this->_publishInterval = network._publishInterval;
+    this->_checkpointer = nullptr;
+    this->_historyLimit = network._historyLimit;
+    this->_historyStride = network._historyStride;
+    this->_historySkipped = network._historySkipped;
 }
 
 Neural::Network &Neural::Network::operator=(const Neural::Network &network) {
     Neural::ANetworkData::operator=(network);
+    this->_training = network._training;
+    this->_dropoutStep = network._dropoutStep;
+    this->_epoch = network._epoch;
+    this->_position = network._position;
+    this->_errorHistory = network._errorHistory;
+    this->_publisher = nullptr;
+    this->_publishInterval = network._publishInterval;
+    this->_checkpointer = nullptr;
+    this->_historyLimit = network._historyLimit;
+    this->_historyStride = network._historyStride;
+    this->_historySkipped = network._historySkipped;
     return *this;
 }
 
 void Neural::Network::train(INetworkTrainer const &trainer) {
-    std::vector<Neural::INetworkTrainer::TrainingData> const trainingData = trainer.getTrainingData();
+    // Samples are pulled one at a time, the data set may not fit in memory
+    std::unique_ptr<Neural::INetworkTrainer::IReader> reader = trainer.read();
+    for (unsigned long skipped = 0; skipped < this->_position; ++skipped) {
+        if (!reader->next())
+            throw Neural::InvalidTrainingFile("Your network stopped at the sample " + std::to_string(this->_position) + " of its pass but your data set only holds " + std::to_string(skipped) + " samples");
+    }
+    bool training = this->_training;
+    this->_training = true;
 
-    int trainingPass = 0;
-    for (auto const &data: trainingData) {
+    unsigned long trainingPass = this->_position;
+    while (const Neural::INetworkTrainer::TrainingData *sample = reader->next()) {
+        Neural::INetworkTrainer::TrainingData const &data = *sample;
         if (trainer.getDebugFLag()) {
             std::cout << std::endl << "Pass " << trainingPass;
             showVectorVals(": Inputs:", data.input);
@@ -41,37 +84,330 @@ void Neural::Network::train(INetworkTrainer const &trainer) {
             showVectorVals("Outputs:", result);
             showVectorVals("Targets:", data.output);
         }
-        if (data.output.size() != trainer.getTopology().back()) {
-            throw Neural::InvalidTrainingFile("Your are requesting " + std::to_string(data.output.size()) + " output data but your network can only output " + std::to_string(trainer.getTopology().back()) + "..");
+        if (data.output.size() != trainer.getTopology().getOutputCount()) {
+            throw Neural::InvalidTrainingFile("Your are requesting " + std::to_string(data.output.size()) + " output data but your network can only output " + std::to_string(trainer.getTopology().getOutputCount()) + "..");
             return;
         }
         this->backProp(data.output);
         if (trainer.getDebugFLag())
             std::cout << "Network recent average error: " << this->getRecentAverageError() << std::endl;
 
+        // The position is saved with the checkpoint taken right after it
         trainingPass++;
+        this->_position = trainingPass;
+        this->trained(trainingPass);
     }
+    this->_position = 0;
+    this->_epoch++;
+    this->_training = training;
+    this->trainingDone();
     if (trainer.getDebugFLag())
         std::cout << std::endl << "Done" << std::endl;
 }
 
+unsigned long Neural::Network::train(SampleStream &stream) {
+    Neural::INetworkTrainer::TrainingData data;
+    bool training = this->_training;
+    this->_training = true;
+
+    unsigned long trainingPass = 0;
+    while (stream.next(data)) {
+        if (data.input.size() != this->getInputCount() || data.output.size() != this->getOutputCount()) {
+            stream.reject();
+            continue;
+        }
+        try {
+            this->feedForward(data.input);
+        } catch (Neural::InvalidInput const &) {
+            stream.reject();
+            continue;
+        }
+        this->backProp(data.output);
+        trainingPass++;
+        this->trained(trainingPass);
+    }
+    this->_training = training;
+    this->trainingDone();
+    return trainingPass;
+}
+
+void Neural::Network::trained(unsigned long trainingPass) {
+    if (this->_publisher && trainingPass % this->_publishInterval == 0)
+        this->_publisher->publish(*this);
+    if (this->_checkpointer)
+        this->_checkpointer->sample(*this);
+}
+
+void Neural::Network::trainingDone() {
+    if (this->_publisher)
+        this->_publisher->publish(*this);
+    if (this->_checkpointer) {
+        this->_checkpointer->save(*this);
+        this->_checkpointer->flush();
+    }
+}
+
+void Neural::Network::loadFrom(const ModelFile &file) {
+    uint64_t count;
+    std::vector<double> storage;
+
+    ANetworkData::loadFrom(file);
+    this->_dropoutStep = 0;
+    this->_epoch = 0;
+    this->_position = 0;
+    this->_historyStride = 1;
+    this->_historySkipped = 0;
+
+    const double *state = file.getBlock(ModelFile::TrainingState, 0, count, storage);
+    if (state != nullptr) {
+        if (count != 6)
+            throw Neural::InvalidSavingFile("Your model file holds a training state of " + std::to_string(count) + " values instead of 6");
+        uint64_t values[6];
+        memcpy(values, state, sizeof(values));
+        this->_epoch = values[0];
+        this->_position = values[1];
+        this->_dropoutStep = values[2];
+        this->_historyStride = values[3];
+        this->_historySkipped = values[4];
+        this->_seed = values[5];
+    }
+    const double *history = file.getBlock(ModelFile::ErrorHistory, 0, count, storage);
+    if (history != nullptr)
+        this->_errorHistory.assign(history, history + count);
+}
+
+void Neural::Network::snapshot(ModelFile::Content &content) const {
+    ANetworkData::snapshot(content);
+
+    uint64_t const values[6] = {this->_epoch, this->_position, this->_dropoutStep, this->_historyStride, this->_historySkipped, this->_seed};
+    content.blocks.push_back(ModelFile::Block{ModelFile::TrainingState, 0, std::vector<double>(6)});
+    memcpy(content.blocks.back().values.data(), values, sizeof(values));
+    content.blocks.push_back(ModelFile::Block{ModelFile::ErrorHistory, 0, this->_errorHistory});
+}
+
+unsigned long Neural::Network::getEpoch() const {
+    return this->_epoch;
+}
+
+unsigned long Neural::Network::getPosition() const {
+    return this->_position;
+}
+
+void Neural::Network::restart() {
+    this->_epoch = 0;
+    this->_position = 0;
+}
+
 void Neural::Network::feedForward(const std::vector<double> &inputVals) {
-    if (inputVals.size() != this->_layers[0].size() - 1) {
-        throw Neural::InvalidInput("You want to input " + std::to_string(inputVals.size()) + " values but your network can only accept " + std::to_string(this->_layers[0].size() - 1));
+    if (inputVals.size() != this->getInputCount()) {
+        throw Neural::InvalidInput("You want to input " + std::to_string(inputVals.size()) + " values but your network can only accept " + std::to_string(this->getInputCount()));
+    }
+
+    // Run the transform layers, the last one feeds the input neurons
+    const std::vector<double> *values = &inputVals;
+    for (auto &transform: this->_transforms) {
+        transform->feedForward(*values);
+        values = &transform->getOutput();
+    }
+    this->forwardLayers(*values);
+}
+
+std::vector<double> const &Neural::Network::predict(const std::vector<double> &inputVals, Workspace &workspace) const {
+    if (inputVals.size() != this->getInputCount()) {
+        throw Neural::InvalidInput("You want to input " + std::to_string(inputVals.size()) + " values but your network can only accept " + std::to_string(this->getInputCount()));
+    }
+
+    const std::vector<double> *values = &inputVals;
+    unsigned buffer = 0;
+    for (auto const &transform: this->_transforms) {
+        std::vector<double> &output = workspace.getBuffer(buffer++);
+        transform->predict(*values, output, workspace.getScratch());
+        values = &output;
     }
 
+    // Same sums as Neuron::feedForward, weights read from the previous layer, bias last
+    for (unsigned layerNum = 1; layerNum < this->_layers.size(); ++layerNum) {
+        Layer const &prevLayer = this->_layers[layerNum - 1];
+        std::vector<BatchNorm> const &batchNorms = this->_batchNorms[layerNum];
+        bool softmax = this->_loss == Topology::SoftmaxCrossEntropy && layerNum == this->_layers.size() - 1;
+        unsigned count = this->_layers[layerNum].size() - 1;
+        std::vector<double> &output = layerNum == this->_layers.size() - 1 ? workspace.getOutput() : workspace.getBuffer(buffer++);
+        output.resize(count);
+        for (unsigned n = 0; n < count; ++n) {
+            double sum = 0.0;
+            for (unsigned i = 0; i < values->size(); ++i) {
+                sum += (*values)[i] * prevLayer[i].getConnection()[n].weight;
+            }
+            sum += prevLayer.back().getOutputVal() * prevLayer.back().getConnection()[n].weight;
+            if (!batchNorms.empty())
+                sum = batchNorms[n].infer(sum);
+            output[n] = softmax ? sum : tanh(sum);
+        }
+        values = &output;
+    }
+
+    std::vector<double> &output = workspace.getOutput();
+    if (this->_loss == Topology::SoftmaxCrossEntropy) {
+        // Same arithmetic as softmax() so that both paths agree
+        double max = *std::max_element(output.begin(), output.end());
+        double sum = 0.0;
+        for (double value: output) {
+            sum += exp(value - max);
+        }
+        double logSum = max + log(sum);
+        for (double &value: output) {
+            value = exp(value - logSum);
+        }
+    }
+    return output;
+}
+
+void Neural::Network::streamForward(const std::vector<double> &frame) {
+    Neural::RecurrentLayer *recurrent = this->getStream();
+
+    // The recurrent layer carries its state, the layers after it see one step
+    recurrent->step(frame);
+    const std::vector<double> *values = &recurrent->getOutput();
+    for (unsigned n = 1; n < this->_transforms.size(); ++n) {
+        this->_transforms[n]->feedForward(*values);
+        values = &this->_transforms[n]->getOutput();
+    }
+    this->forwardLayers(*values);
+}
+
+void Neural::Network::resetStream() {
+    this->getStream()->resetState();
+}
+
+Neural::RecurrentLayer *Neural::Network::getStream() const {
+    Neural::RecurrentLayer *recurrent = this->_transforms.empty() ? nullptr : dynamic_cast<Neural::RecurrentLayer *>(this->_transforms.front().get());
+
+    if (recurrent == nullptr)
+        throw Neural::NetworkException("Streaming inference needs a network starting with a lstm or gru layer");
+    return recurrent;
+}
+
+void Neural::Network::forwardLayers(const std::vector<double> &values) {
+    // The dropout mask of a layer is drawn first, then applied to every output as it is computed
+    const std::vector<double> *mask = nullptr;
+    if (this->_training) {
+        this->_dropoutStep++;
+        mask = this->dropout(0);
+    }
     // Assign (latch) the input values into the input neurons
-    for (unsigned i = 0; i < inputVals.size(); ++i) {
-        this->_layers[0][i].setOutputVal(inputVals[i]);
+    for (unsigned i = 0; i < values.size(); ++i) {
+        this->_layers[0][i].setOutputVal(mask ? values[i] * (*mask)[i] : values[i]);
     }
 
-    // forward propagate
+    // forward propagate, a softmax output layer keeps its raw sums
     for (unsigned layerNum = 1; layerNum < this->_layers.size(); ++layerNum) {
         Layer &prevLayer = this->_layers[layerNum - 1];
+        std::vector<BatchNorm> &batchNorms = this->_batchNorms[layerNum];
+        bool softmax = this->_loss == Topology::SoftmaxCrossEntropy && layerNum == this->_layers.size() - 1;
+        mask = this->_training ? this->dropout(layerNum) : nullptr;
         for (unsigned n = 0; n < this->_layers[layerNum].size() - 1; ++n) {
-            this->_layers[layerNum][n].feedForward(prevLayer);
+            Neuron &neuron = this->_layers[layerNum][n];
+            if (!softmax && batchNorms.empty()) {
+                neuron.feedForward(prevLayer);
+            } else {
+                double sum = neuron.sumInputs(prevLayer);
+                if (!batchNorms.empty())
+                    sum = batchNorms[n].forward(sum, this->_training);
+                if (softmax)
+                    neuron.setOutputVal(sum);
+                else
+                    neuron.activate(sum);
+            }
+            if (mask)
+                neuron.setOutputVal(neuron.getOutputVal() * (*mask)[n]);
         }
     }
+    if (this->_loss == Topology::SoftmaxCrossEntropy)
+        this->softmax(this->_layers.back());
+}
+
+const std::vector<double> *Neural::Network::dropout(unsigned layerNum) {
+    double rate = this->_dropout[layerNum];
+    unsigned count = this->_layers[layerNum].size() - 1;
+
+    this->_dropoutMasks.resize(this->_layers.size());
+    std::vector<double> &mask = this->_dropoutMasks[layerNum];
+    if (rate == 0.0) {
+        mask.clear();
+        return nullptr;
+    }
+
+    // Inverted dropout, the kept outputs are scaled so that inference needs no correction.
+    // Every lane hashes its own counter, the mask loop has no dependency between neurons.
+    uint64_t key = Random::hash(this->_seed ^ Random::hash((this->_dropoutStep << 16) | layerNum));
+    double scale = 1.0 / (1.0 - rate);
+    mask.resize(count);
+    for (unsigned n = 0; n < count; ++n) {
+        double draw = (Random::hash(key + n) >> 11) * 0x1.0p-53;
+        mask[n] = draw < rate ? 0.0 : scale;
+    }
+    return &mask;
+}
+
+void Neural::Network::publishTo(SnapshotPublisher *publisher, unsigned interval) {
+    this->_publisher = publisher;
+    this->_publishInterval = std::max(1u, interval);
+}
+
+void Neural::Network::checkpointTo(Checkpointer *checkpointer) {
+    this->_checkpointer = checkpointer;
+}
+
+void Neural::Network::setHistoryLimit(unsigned limit) {
+    this->_historyLimit = limit;
+}
+
+std::vector<double> const &Neural::Network::getErrorHistory() const {
+    return this->_errorHistory;
+}
+
+void Neural::Network::recordError() {
+    if (++this->_historySkipped < this->_historyStride)
+        return;
+    this->_historySkipped = 0;
+    this->_errorHistory.push_back(this->_recentAverageError);
+
+    // Keep one point out of two and sample the next ones half as often, the plot keeps its whole span
+    if (this->_historyLimit != 0 && this->_errorHistory.size() >= std::max(2u, this->_historyLimit)) {
+        unsigned half = this->_errorHistory.size() / 2;
+        for (unsigned n = 0; n < half; ++n) {
+            this->_errorHistory[n] = this->_errorHistory[2 * n + 1];
+        }
+        this->_errorHistory.resize(half);
+        this->_historyStride *= 2;
+    }
+}
+
+void Neural::Network::setTraining(bool training) {
+    this->_training = training;
+}
+
+bool Neural::Network::isTraining() const {
+    return this->_training;
+}
+
+void Neural::Network::softmax(Layer &outputLayer) {
+    // log p = z - log(sum(exp(z))), shifted by max(z) so that exp never overflows
+    unsigned count = outputLayer.size() - 1;
+    double max = outputLayer[0].getOutputVal();
+    for (unsigned n = 1; n < count; ++n) {
+        max = std::max(max, outputLayer[n].getOutputVal());
+    }
+    double sum = 0.0;
+    for (unsigned n = 0; n < count; ++n) {
+        sum += exp(outputLayer[n].getOutputVal() - max);
+    }
+    double logSum = max + log(sum);
+    this->_logProbabilities.resize(count);
+    for (unsigned n = 0; n < count; ++n) {
+        this->_logProbabilities[n] = outputLayer[n].getOutputVal() - logSum;
+        outputLayer[n].setOutputVal(exp(this->_logProbabilities[n]));
+    }
 }
 
 std::vector<double> const Neural::Network::getResults() const {
@@ -84,34 +420,63 @@ std::vector<double> const Neural::Network::getResults() const {
 }
 
 void Neural::Network::backProp(const std::vector<double> &targetVals) {
-    // Calculate overall net error (RMS of output neuron errors)
     Layer &outputLayer = this->_layers.back();
     this->_error = 0.0;
 
-    for (unsigned n = 0; n < outputLayer.size() - 1; ++n) {
-        double delta = targetVals[n] - outputLayer[n].getOutputVal();
-        this->_error += delta * delta;
+    if (this->_loss == Topology::SoftmaxCrossEntropy) {
+        // Cross entropy, its gradient through the softmax is simply target - output
+        for (unsigned n = 0; n < outputLayer.size() - 1; ++n) {
+            this->_error -= targetVals[n] * this->_logProbabilities[n];
+            outputLayer[n].setGradient(targetVals[n] - outputLayer[n].getOutputVal());
+        }
+    } else {
+        // Calculate overall net error (RMS of output neuron errors)
+        for (unsigned n = 0; n < outputLayer.size() - 1; ++n) {
+            double delta = targetVals[n] - outputLayer[n].getOutputVal();
+            this->_error += delta * delta;
+        }
+        this->_error /= outputLayer.size() - 1; // get average error squared
+        this->_error = sqrt(this->_error); // RMS
+
+        // Calculate output layer gradients
+        for (unsigned n = 0; n < outputLayer.size() - 1; ++n) {
+            outputLayer[n].calcOutputGradients(targetVals[n]);
+        }
     }
-    this->_error /= outputLayer.size() - 1; // get average error squared
-    this->_error = sqrt(this->_error); // RMS
+    this->backPropBatchNorm(this->_layers.size() - 1);
 
 
     // Implement a recent average measurement
     this->_recentAverageError = (this->_recentAverageError * this->_recentAverageSmoothingFactor + this->_error) / (this->_recentAverageSmoothingFactor + 1.0);
 
-    this->_errorHistory.push_back(this->_recentAverageError);
-
-    // Calculate output layer gradients
-    for (unsigned n = 0; n < outputLayer.size() - 1; ++n) {
-        outputLayer[n].calcOutputGradients(targetVals[n]);
-    }
+    this->recordError();
 
     // Calculate hidden layer gradients
     for (unsigned layerNum = this->_layers.size() - 2; layerNum > 0; --layerNum) {
         Layer &hiddenLayer = this->_layers[layerNum];
         Layer &nextLayer = this->_layers[layerNum + 1];
+        bool masked = this->_training && layerNum < this->_dropoutMasks.size() && !this->_dropoutMasks[layerNum].empty();
         for (unsigned n = 0; n < hiddenLayer.size(); ++n) {
-            hiddenLayer[n].calcHiddenGradients(nextLayer);
+            if (masked && n < hiddenLayer.size() - 1)
+                hiddenLayer[n].calcHiddenGradients(nextLayer, this->_dropoutMasks[layerNum][n]);
+            else
+                hiddenLayer[n].calcHiddenGradients(nextLayer);
+        }
+        this->backPropBatchNorm(layerNum);
+    }
+
+    // Gradients at the input neurons, taken before the weights move
+    if (!this->_transforms.empty()) {
+        Layer &inputLayer = this->_layers[0];
+        Layer &nextLayer = this->_layers[1];
+        this->_transformGradients.assign(inputLayer.size() - 1, 0.0);
+        for (unsigned i = 0; i < inputLayer.size() - 1; ++i) {
+            std::vector<Neural::INeuron::Connection> const &connections = inputLayer[i].getConnection();
+            for (unsigned n = 0; n < nextLayer.size() - 1; ++n) {
+                this->_transformGradients[i] += connections[n].weight * nextLayer[n].getGradient();
+            }
+            if (this->_training && !this->_dropoutMasks.empty() && !this->_dropoutMasks[0].empty())
+                this->_transformGradients[i] *= this->_dropoutMasks[0][i];
         }
     }
 
@@ -124,6 +489,26 @@ void Neural::Network::backProp(const std::vector<double> &targetVals) {
             layer[n].updateInputWeights(prevLayer);
         }
     }
+
+    this->backPropTransforms();
+}
+
+void Neural::Network::backPropBatchNorm(unsigned layerNum) {
+    // Gradients at the normalized values become gradients at the raw sums
+    std::vector<BatchNorm> &batchNorms = this->_batchNorms[layerNum];
+    for (unsigned n = 0; n < batchNorms.size(); ++n) {
+        Neuron &neuron = this->_layers[layerNum][n];
+        neuron.setGradient(batchNorms[n].backward(neuron.getGradient()));
+    }
+}
+
+void Neural::Network::backPropTransforms() {
+    const std::vector<double> *gradients = &this->_transformGradients;
+
+    for (unsigned t = this->_transforms.size(); t-- > 0;) {
+        this->_transforms[t]->backProp(*gradients);
+        gradients = &this->_transforms[t]->getInputGradients();
+    }
 }
 
 void Neural::Network::showVectorVals(std::string const &label, std::vector<double> const &v) const {
@@ -150,6 +535,9 @@ std::ostream &operator<<(std::ostream& os, const Neural::Network &network) {
     os << "\tIt takes " << network.getInputCount() << " input" << (network.getInputCount() > 1 ? "s" : "") <<" and give in return " << network.getOutputCount() << " output" << (network.getOutputCount() > 1 ? "s" : "") << std::endl;
     os << "\tIt has a total of " << network.getNeuronCount() << " neurons and " << network.getConnectionCount() << " connections" << std::endl;
     os << "\tIts recent average error factor is " << network.getRecentAverageError() << std::endl;
+    for (auto const &transform: network.getTransforms()) {
+        os << "\tTransform layer " << transform->getDescription() << ", " << transform->getInputShape().toString() << " to " << transform->getOutputShape().toString() << " with " << transform->getParameters().size() << " parameters" << std::endl;
+    }
     os << std::endl << "\t|--------- Layer Status ---------|" << std::endl;
     unsigned i = 0;
     for (auto const &layer: layers) {
@@ -0,0 +1,95 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   05/05/2018 15:42:10
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 05/05/2018 18:03:27
+ */
+
+
+#include "NetworkPruner.hpp"
+
+Neural::NetworkPruner::NetworkPruner(double threshold) {
+    this->_threshold = threshold;
+}
+
+Neural::NetworkPruner::~NetworkPruner() {
+
+}
+
+Neural::NetworkPruner::NetworkPruner(const NetworkPruner &pruner) {
+    this->_threshold = pruner._threshold;
+}
+
+Neural::NetworkPruner &Neural::NetworkPruner::operator =(const NetworkPruner &pruner) {
+    this->_threshold = pruner._threshold;
+    return *this;
+}
+
+std::vector<std::vector<Neural::INetworkPruner::NeuronStatistics>> Neural::NetworkPruner::analyze(Network const &network, INetworkTrainer const &trainer) const {
+    std::vector<std::vector<NeuronStatistics>> statistics;
+    std::vector<Neural::Layer> const &layers = network.getLayer();
+
+    // statistics[layerNum][neuronNum], bias neurons excluded
+    for (auto const &layer: layers) {
+        statistics.emplace_back(layer.size() - 1, NeuronStatistics{0.0, 0.0, 0.0});
+    }
+
+    // Running mean and variance (Welford) of every neuron output over the training set,
+    // computed on a copy so the analysed network keeps its state
+    Network probe(network);
+    unsigned count = 0;
+    std::unique_ptr<INetworkTrainer::IReader> reader = trainer.read();
+    while (const INetworkTrainer::TrainingData *data = reader->next()) {
+        probe.feedForward(data->input);
+        count++;
+        for (unsigned layerNum = 0; layerNum < layers.size(); ++layerNum) {
+            for (unsigned n = 0; n < statistics[layerNum].size(); ++n) {
+                NeuronStatistics &stats = statistics[layerNum][n];
+                double value = probe.getLayer()[layerNum][n].getOutputVal();
+                double delta = value - stats.mean;
+                stats.mean += delta / count;
+                stats.variance += delta * (value - stats.mean);
+            }
+        }
+    }
+
+    for (unsigned layerNum = 0; layerNum < layers.size(); ++layerNum) {
+        for (unsigned n = 0; n < statistics[layerNum].size(); ++n) {
+            NeuronStatistics &stats = statistics[layerNum][n];
+            stats.variance = count > 1 ? stats.variance / (count - 1) : 0.0;
+            for (auto const &connection: layers[layerNum][n].getConnection()) {
+                stats.maxOutputWeight = std::max(stats.maxOutputWeight, std::fabs(connection.weight));
+            }
+        }
+    }
+    return statistics;
+}
+
+unsigned Neural::NetworkPruner::prune(Network &network, INetworkTrainer const &trainer) const {
+    std::vector<std::vector<NeuronStatistics>> statistics = this->analyze(network, trainer);
+    unsigned removed = 0;
+
+    // Only hidden layers are pruned, walking neurons backward keeps the remaining indexes valid
+    for (unsigned layerNum = 1; layerNum + 1 < statistics.size(); ++layerNum) {
+        for (unsigned n = statistics[layerNum].size(); n-- > 0;) {
+            if (!this->isDead(statistics[layerNum][n]) || network.getLayer()[layerNum].size() <= 2)
+                continue;
+            network.removeNeuron(layerNum, n, statistics[layerNum][n].mean);
+            removed++;
+        }
+    }
+    return removed;
+}
+
+void Neural::NetworkPruner::setThreshold(double threshold) {
+    this->_threshold = threshold;
+}
+
+double Neural::NetworkPruner::getThreshold() const {
+    return this->_threshold;
+}
+
+bool Neural::NetworkPruner::isDead(NeuronStatistics const &stats) const {
+    return stats.maxOutputWeight < this->_threshold || std::sqrt(stats.variance) < this->_threshold;
+}
@@ -7,30 +7,112 @@
  */
 
 
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
 #include "NetworkTrainer.hpp"
+#include "DatasetParser.hpp"
+#include "ThreadPool.hpp"
+
+class Neural::NetworkTrainer::Reader : public INetworkTrainer::IReader {
+
+public:
+    Reader(NetworkTrainer const &trainer): _trainer(trainer), _random(trainer._drawSeed) {
+        this->_next = 0;
+    }
+
+    // Copied into vectors that keep their capacity, nothing is allocated past the first samples
+    const TrainingData *next() {
+        if (this->_next == this->_trainer.getSampleCount())
+            return nullptr;
+        size_t index = this->_next++;
+        if (!this->_trainer._weights.empty()) {
+            unsigned column = this->_random.below(this->_trainer._weights.size());
+            index = this->_random.uniform() < this->_trainer._probabilities[column] ? column : this->_trainer._aliases[column];
+        }
+        Sample const &sample = this->_trainer._samples[index];
+        const double *values = this->_trainer._values.data() + sample.offset;
+        this->_data.input.assign(values, values + sample.inputs);
+        this->_data.output.assign(values + sample.inputs, values + sample.inputs + sample.outputs);
+        return &this->_data;
+    }
+
+private:
+    NetworkTrainer const &_trainer;
+    Random _random;
+    size_t _next;
+    TrainingData _data;
+
+};
+
+// Smallest chunk given to a thread, below that the stitching costs more than it saves
+static const size_t ChunkSize = 1 << 22;
 
 Neural::NetworkTrainer::NetworkTrainer(const std::string filename) {
     this->_debug = false;
-    std::ifstream file;
-    file.open(filename.c_str());
-    if (file) {
-        this->_topology = readTopology(file);
-        while (!file.eof()) {
-            Neural::INetworkTrainer::TrainingData data;
-            data.input = readNextInputs(file);
-            if (data.input.size() == 0)
-                break;
-            if (file.eof())
-                throw Neural::InvalidTrainingFile("You training file is giving an input sample without specifying an output corresponding");
-            data.output = readTargetOutputs(file);
-            if (data.output.size() == 0)
-                throw Neural::InvalidTrainingFile("You training file is giving an input sample without specifying an output corresponding");
-            this->_trainingData.push_back(data);
-        }
-        file.close();
-    } else {
-        throw Neural::InvalidTrainingFile("Your training file " + filename + " could not be found");
+    this->_total = 0;
+    this->_drawSeed = Random::DefaultSeed;
+    DatasetParser parser(filename);
+    this->_topology = parser.getTopology();
+
+    // A few chunks per thread, so that the threads given the lighter ones take the others
+    ThreadPool &pool = ThreadPool::shared();
+    size_t begin = parser.getPosition();
+    size_t size = parser.getSize() - begin;
+    size_t chunks = pool.getThreadCount() > 1 ? std::min<size_t>(pool.getThreadCount() * 4, size / ChunkSize) : 1;
+    if (chunks <= 1) {
+        load(parser, parser.getSize(), this->_values, this->_samples);
+        return;
     }
+
+    std::vector<size_t> bounds(chunks + 1, parser.getSize());
+    bounds[0] = begin;
+    for (size_t n = 1; n < chunks; ++n) {
+        bounds[n] = parser.findRecord(std::max(bounds[n - 1], begin + size * n / chunks));
+    }
+
+    std::vector<std::vector<double>> values(chunks);
+    std::vector<std::vector<Sample>> samples(chunks);
+    std::vector<char> stopped(chunks, false);
+    std::vector<std::future<void>> futures;
+    for (size_t n = 0; n < chunks; ++n) {
+        futures.push_back(pool.submit([&, n]() {
+            DatasetParser chunk(filename);
+            chunk.setRange(bounds[n], bounds[n + 1]);
+            load(chunk, bounds[n + 1], values[n], samples[n]);
+            stopped[n] = chunk.hasStopped();
+        }));
+    }
+    for (auto &future: futures) {
+        future.wait();
+    }
+
+    // Same samples and errors as one parser: nothing is kept past the chunk where they stopped
+    std::vector<size_t> valueOffsets(1, 0);
+    std::vector<size_t> sampleOffsets(1, 0);
+    size_t used = 0;
+    while (used < chunks) {
+        futures[used].get();
+        valueOffsets.push_back(valueOffsets.back() + values[used].size());
+        sampleOffsets.push_back(sampleOffsets.back() + samples[used].size());
+        if (stopped[used++])
+            break;
+    }
+    this->_values.resize(valueOffsets.back());
+    this->_samples.resize(sampleOffsets.back());
+    pool.parallelFor(used, [&](unsigned first, unsigned last) {
+        for (unsigned n = first; n < last; ++n) {
+            std::copy(values[n].begin(), values[n].end(), this->_values.begin() + valueOffsets[n]);
+            for (size_t s = 0; s < samples[n].size(); ++s) {
+                Sample sample = samples[n][s];
+                sample.offset += valueOffsets[n];
+                this->_samples[sampleOffsets[n] + s] = sample;
+            }
+            std::vector<double>().swap(values[n]);
+            std::vector<Sample>().swap(samples[n]);
+        }
+    });
 }
 
 Neural::NetworkTrainer::~NetworkTrainer() {
@@ -38,88 +120,143 @@ Neural::NetworkTrainer::~NetworkTrainer() {
 }
 
 Neural::NetworkTrainer::NetworkTrainer(const NetworkTrainer &trainer) {
+    this->_debug = trainer._debug;
     this->_topology = trainer._topology;
-    this->_trainingData = trainer._trainingData;
+    this->_values = trainer._values;
+    this->_samples = trainer._samples;
+    this->_weights = trainer._weights;
+    this->_probabilities = trainer._probabilities;
+    this->_aliases = trainer._aliases;
+    this->_total = trainer._total;
+    this->_drawSeed = trainer._drawSeed;
 }
 
 Neural::NetworkTrainer &Neural::NetworkTrainer::operator =(const NetworkTrainer &trainer) {
+    this->_debug = trainer._debug;
     this->_topology = trainer._topology;
-    this->_trainingData = trainer._trainingData;
+    this->_values = trainer._values;
+    this->_samples = trainer._samples;
+    this->_weights = trainer._weights;
+    this->_probabilities = trainer._probabilities;
+    this->_aliases = trainer._aliases;
+    this->_total = trainer._total;
+    this->_drawSeed = trainer._drawSeed;
     return *this;
 }
 
 
-std::vector<unsigned> const &Neural::NetworkTrainer::getTopology() const {
+Neural::Topology const &Neural::NetworkTrainer::getTopology() const {
     return this->_topology;
 }
 
-std::vector<Neural::INetworkTrainer::TrainingData> const &Neural::NetworkTrainer::getTrainingData() const {
-    return this->_trainingData;
+std::unique_ptr<Neural::INetworkTrainer::IReader> Neural::NetworkTrainer::read() const {
+    return std::unique_ptr<IReader>(new Reader(*this));
 }
 
-void Neural::NetworkTrainer::setDebugFLag(bool mode) {
-    this->_debug = mode;
-}
-
-bool Neural::NetworkTrainer::getDebugFLag() const {
-    return this->_debug;
+size_t Neural::NetworkTrainer::getSampleCount() const {
+    return this->_weights.empty() ? this->_samples.size() : this->_total;
 }
 
+size_t Neural::NetworkTrainer::deduplicate() {
+    if (!this->_weights.empty())
+        return this->_samples.size();
 
-std::vector<unsigned> Neural::NetworkTrainer::readTopology(std::ifstream &file) const {
-    std::vector<unsigned> topology;
-    std::string line;
-    std::string label;
-
-    getline(file, line);
-    std::stringstream ss(line);
-    ss >> label;
-    if (file.eof() || label.compare("topology:") != 0) {
-        throw Neural::InvalidTrainingFile("You training file does not contain a topology brief");
+    // Samples are the same when their values are, bit for bit
+    auto hash = [this](Sample const &sample) {
+        uint64_t hash = Random::hash(sample.inputs);
+        for (size_t n = 0; n < sample.inputs + sample.outputs; ++n) {
+            uint64_t bits;
+            memcpy(&bits, &this->_values[sample.offset + n], sizeof(bits));
+            hash = Random::hash(hash ^ bits);
+        }
+        return hash;
+    };
+    std::vector<double> values;
+    std::vector<Sample> samples;
+    std::unordered_multimap<uint64_t, size_t> unique;
+    for (Sample const &sample: this->_samples) {
+        const double *row = this->_values.data() + sample.offset;
+        uint64_t key = hash(sample);
+        auto range = unique.equal_range(key);
+        auto found = std::find_if(range.first, range.second, [&](std::pair<const uint64_t, size_t> const &candidate) {
+            Sample const &kept = samples[candidate.second];
+            return kept.inputs == sample.inputs && kept.outputs == sample.outputs && memcmp(values.data() + kept.offset, row, (sample.inputs + sample.outputs) * sizeof(double)) == 0;
+        });
+        if (found != range.second) {
+            this->_weights[found->second]++;
+            continue;
+        }
+        unique.emplace(key, samples.size());
+        samples.push_back(Sample{values.size(), sample.inputs, sample.outputs});
+        values.insert(values.end(), row, row + sample.inputs + sample.outputs);
+        this->_weights.push_back(1);
     }
+    this->_total = this->_samples.size();
+    this->_values.swap(values);
+    this->_samples.swap(samples);
+    std::vector<double>(this->_values).swap(this->_values);
+    std::vector<Sample>(this->_samples).swap(this->_samples);
 
-    while (!ss.eof()) {
-        unsigned n;
-        ss >> n;
-        topology.push_back(n);
+    // Vose: every column holds a sample with its probability, and the alias filling the rest
+    size_t count = this->_weights.size();
+    std::vector<double> scaled(count);
+    std::vector<unsigned> small;
+    std::vector<unsigned> large;
+    this->_probabilities.assign(count, 1.0);
+    this->_aliases.resize(count);
+    for (unsigned n = 0; n < count; ++n) {
+        scaled[n] = (double)this->_weights[n] * count / this->_total;
+        this->_aliases[n] = n;
+        (scaled[n] < 1.0 ? small : large).push_back(n);
     }
-    return topology;
+    while (!small.empty() && !large.empty()) {
+        unsigned less = small.back();
+        unsigned more = large.back();
+        small.pop_back();
+        large.pop_back();
+        this->_probabilities[less] = scaled[less];
+        this->_aliases[less] = more;
+        scaled[more] += scaled[less] - 1.0;
+        (scaled[more] < 1.0 ? small : large).push_back(more);
+    }
+    return count;
 }
 
-std::vector<double> Neural::NetworkTrainer::readNextInputs(std::ifstream &file) const {
-    std::vector<double> inputVals;
-
-    std::string line;
-    getline(file, line);
-    std::stringstream ss(line);
+size_t Neural::NetworkTrainer::getUniqueCount() const {
+    return this->_samples.size();
+}
 
-    std::string label;
-    ss>> label;
-    if (label.compare("in:") == 0) {
-        double oneValue;
-        while (ss >> oneValue) {
-            inputVals.push_back(oneValue);
-        }
+void Neural::NetworkTrainer::shuffle(Random &random) {
+    // The draws of a deduplicated data set are already in random order, they start over elsewhere
+    if (!this->_weights.empty()) {
+        this->_drawSeed = random.next();
+        return;
+    }
+    // Fisher-Yates
+    for (unsigned n = this->_samples.size(); n > 1; --n) {
+        std::swap(this->_samples[n - 1], this->_samples[random.below(n)]);
     }
-
-    return inputVals;
 }
 
-std::vector<double> Neural::NetworkTrainer::readTargetOutputs(std::ifstream &file) const {
-    std::vector<double> targetOutputVals;
-
-    std::string line;
-    getline(file, line);
-    std::stringstream ss(line);
-
-    std::string label;
-    ss>> label;
-    if (label.compare("out:") == 0) {
-        double oneValue;
-        while (ss >> oneValue) {
-            targetOutputVals.push_back(oneValue);
+void Neural::NetworkTrainer::load(DatasetParser &parser, size_t end, std::vector<double> &values, std::vector<Sample> &samples) {
+    size_t begin = parser.getPosition();
+    unsigned inputs, outputs;
+    while (parser.next(values, inputs, outputs)) {
+        samples.push_back(Sample{values.size() - inputs - outputs, inputs, outputs});
+        // The first sample tells about how many the range holds, the arena is sized once
+        if (samples.size() == 1) {
+            double count = (double)(end - begin) / (parser.getPosition() - begin);
+            values.reserve(count * (inputs + outputs));
+            samples.reserve(count);
         }
     }
+}
 
-    return targetOutputVals;
+void Neural::NetworkTrainer::setDebugFLag(bool mode) {
+    this->_debug = mode;
 }
+
+bool Neural::NetworkTrainer::getDebugFLag() const {
+    return this->_debug;
+}
+
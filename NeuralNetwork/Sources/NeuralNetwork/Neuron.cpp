@@ -12,10 +12,8 @@
 Neural::Neuron::Neuron(unsigned numOutputs, unsigned myIndex, double eta, double alpha) {
     this->_eta = eta;
     this->_alpha = alpha;
-    for (unsigned c = 0; c < numOutputs; ++c) {
-        this->_outputWeights.push_back(Connection());
-        this->_outputWeights.back().weight = randomWeight();
-    }
+    // The weights are set by the Initializer of the network
+    this->_outputWeights.assign(numOutputs, Connection{0.0, 0.0});
 
     this->_myIndex = myIndex;
 }
@@ -51,7 +49,15 @@ double Neural::Neuron::getOutputVal(void) const {
     return this->_outputVal;
 }
 
-void Neural::Neuron::feedForward(const Layer &prevLayer) {
+double Neural::Neuron::getGradient(void) const {
+    return this->_gradient;
+}
+
+void Neural::Neuron::setGradient(double gradient) {
+    this->_gradient = gradient;
+}
+
+double Neural::Neuron::sumInputs(const Layer &prevLayer) const {
     double sum = 0.0;
 
     // Sum the previous layer's outputs (which are our inputs)
@@ -60,6 +66,14 @@ void Neural::Neuron::feedForward(const Layer &prevLayer) {
         sum += prevLayer[n].getOutputVal() *
                 prevLayer[n]._outputWeights[this->_myIndex].weight;
     }
+    return sum;
+}
+
+void Neural::Neuron::feedForward(const Layer &prevLayer) {
+    this->activate(this->sumInputs(prevLayer));
+}
+
+void Neural::Neuron::activate(double sum) {
     this->_outputVal = Neural::Neuron::transferFunction(sum);
 }
 
@@ -73,6 +87,16 @@ void Neural::Neuron::calcHiddenGradients(const Layer &nextLayer) {
     this->_gradient = dow * Neural::Neuron::transferFunctionDerivative(this->_outputVal);
 }
 
+void Neural::Neuron::calcHiddenGradients(const Layer &nextLayer, double dropoutScale) {
+    // The output was scaled after the transfer function, 0 when dropped
+    if (dropoutScale == 0.0) {
+        this->_gradient = 0.0;
+        return;
+    }
+    double dow = sumDOW(nextLayer);
+    this->_gradient = dow * dropoutScale * Neural::Neuron::transferFunctionDerivative(this->_outputVal / dropoutScale);
+}
+
 void Neural::Neuron::updateInputWeights(Layer &prevLayer) {
     // The weights to be updated are in the Connection container
     // in the neurons in the preceding layer
@@ -107,6 +131,14 @@ unsigned Neural::Neuron::getConnectionCount() const {
     return this->_outputWeights.size();
 }
 
+void Neural::Neuron::removeConnection(unsigned index) {
+    this->_outputWeights.erase(this->_outputWeights.begin() + index);
+}
+
+void Neural::Neuron::setIndex(unsigned index) {
+    this->_myIndex = index;
+}
+
 double Neural::Neuron::transferFunction(double x) const {
     // tanh - output range [-1.0..1.0]
     return tanh(x);
@@ -117,10 +149,6 @@ double Neural::Neuron::transferFunctionDerivative(double x) const {
     return 1.0 - x * x;
 }
 
-double Neural::Neuron::randomWeight(void) const {
-     return rand() / double(RAND_MAX);
-}
-
 double Neural::Neuron::sumDOW(const Neural::Layer &nextLayer) const {
     double sum = 0.0;
 
@@ -0,0 +1,303 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   06/05/2018 14:20:51
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 06/05/2018 19:47:02
+ */
+
+
+#include "OperatorGraph.hpp"
+
+Neural::OperatorGraph::OperatorGraph(ANetworkData const &network) {
+    this->lower(network);
+}
+
+Neural::OperatorGraph::OperatorGraph(ANetworkData const &network, std::vector<double> const &inputMean, std::vector<double> const &inputDeviation) {
+    if (inputMean.size() != network.getInputCount() || inputDeviation.size() != network.getInputCount())
+        throw Neural::InvalidInput("The input normalization needs " + std::to_string(network.getInputCount()) + " means and deviations");
+
+    Operator normalize{Normalize, Identity, network.getInputCount(), network.getInputCount(), {}, {}};
+    for (unsigned i = 0; i < inputMean.size(); ++i) {
+        double deviation = inputDeviation[i] == 0.0 ? 1.0 : inputDeviation[i];
+        normalize.weights.push_back(1.0 / deviation);
+        normalize.bias.push_back(-inputMean[i] / deviation);
+    }
+    this->_operators.push_back(normalize);
+    this->lower(network);
+}
+
+Neural::OperatorGraph::~OperatorGraph() {
+
+}
+
+Neural::OperatorGraph::OperatorGraph(const OperatorGraph &graph) {
+    this->_operators = graph._operators;
+}
+
+Neural::OperatorGraph &Neural::OperatorGraph::operator =(const OperatorGraph &graph) {
+    this->_operators = graph._operators;
+    return *this;
+}
+
+void Neural::OperatorGraph::lower(ANetworkData const &source) {
+    // Batch normalization costs nothing once folded into the weights
+    ANetworkData network(source);
+    network.foldBatchNorm();
+    std::vector<Neural::Layer> const &layers = network.getLayer();
+
+    if (!network.getTransforms().empty())
+        throw Neural::NetworkException("Networks with transform layers cannot be lowered to an operator graph");
+
+    for (unsigned layerNum = 1; layerNum < layers.size(); ++layerNum) {
+        Layer const &prevLayer = layers[layerNum - 1];
+        unsigned inputSize = prevLayer.size() - 1;
+        unsigned outputSize = layers[layerNum].size() - 1;
+
+        // The weights live in the previous layer neurons, gather them row major
+        Operator matmul{MatMul, Identity, inputSize, outputSize, std::vector<double>(outputSize * inputSize), {}};
+        Operator biasAdd{BiasAdd, Identity, outputSize, outputSize, {}, std::vector<double>(outputSize)};
+        for (unsigned o = 0; o < outputSize; ++o) {
+            for (unsigned i = 0; i < inputSize; ++i) {
+                matmul.weights[o * inputSize + i] = prevLayer[i].getConnection()[o].weight;
+            }
+            biasAdd.bias[o] = prevLayer.back().getConnection()[o].weight;
+        }
+        this->_operators.push_back(matmul);
+        this->_operators.push_back(biasAdd);
+        if (layerNum == layers.size() - 1 && network.getTopology().getLoss() == Topology::SoftmaxCrossEntropy)
+            this->_operators.push_back(Operator{Softmax, Identity, outputSize, outputSize, {}, {}});
+        else
+            this->_operators.push_back(Operator{Activation, Tanh, outputSize, outputSize, {}, {}});
+    }
+}
+
+void Neural::OperatorGraph::fuse() {
+    this->fuseDense();
+    this->foldNormalize();
+}
+
+void Neural::OperatorGraph::fuseDense() {
+    std::vector<Operator> fused;
+
+    for (unsigned n = 0; n < this->_operators.size(); ++n) {
+        Operator const &op = this->_operators[n];
+        if (op.type != MatMul) {
+            fused.push_back(op);
+            continue;
+        }
+        Operator dense{Dense, Identity, op.inputSize, op.outputSize, op.weights, std::vector<double>(op.outputSize, 0.0)};
+        if (n + 1 < this->_operators.size() && this->_operators[n + 1].type == BiasAdd) {
+            dense.bias = this->_operators[++n].bias;
+        }
+        if (n + 1 < this->_operators.size() && this->_operators[n + 1].type == Activation) {
+            dense.transfer = this->_operators[++n].transfer;
+        }
+        fused.push_back(dense);
+    }
+    this->_operators = fused;
+}
+
+void Neural::OperatorGraph::foldNormalize() {
+    // (x * s + t) feeding W . x + b is W' . x + b' with W' = W * s and b' = b + W . t
+    for (unsigned n = 0; n + 1 < this->_operators.size(); ++n) {
+        Operator const &normalize = this->_operators[n];
+        Operator &dense = this->_operators[n + 1];
+        if (normalize.type != Normalize || dense.type != Dense)
+            continue;
+        for (unsigned o = 0; o < dense.outputSize; ++o) {
+            for (unsigned i = 0; i < dense.inputSize; ++i) {
+                dense.bias[o] += dense.weights[o * dense.inputSize + i] * normalize.bias[i];
+                dense.weights[o * dense.inputSize + i] *= normalize.weights[i];
+            }
+        }
+        this->_operators.erase(this->_operators.begin() + n);
+    }
+}
+
+void Neural::OperatorGraph::execute(const std::vector<double> &input, std::vector<double> &output, std::vector<double> &scratch) const {
+    if (input.size() != this->getInputCount()) {
+        throw Neural::InvalidInput("You want to input " + std::to_string(input.size()) + " values but your network can only accept " + std::to_string(this->getInputCount()));
+    }
+    if (this->_operators.empty()) {
+        output = input;
+        return;
+    }
+
+    unsigned width = this->getMaxWidth();
+    output.resize(width);
+    scratch.resize(width);
+
+    // Ping-pong between the two buffers so that the last operator writes into output
+    double *buffers[2] = {output.data(), scratch.data()};
+    const double *source = input.data();
+    unsigned count = this->_operators.size();
+    for (unsigned n = 0; n < count; ++n) {
+        double *destination = buffers[(count - 1 - n) & 1];
+        this->run(this->_operators[n], source, destination);
+        source = destination;
+    }
+    output.resize(this->getOutputCount());
+}
+
+void Neural::OperatorGraph::executeBatch(const std::vector<double> &inputs, unsigned count, std::vector<double> &outputs, std::vector<double> &scratch) const {
+    if (inputs.size() != (size_t)count * this->getInputCount()) {
+        throw Neural::InvalidInput("You want to input " + std::to_string(inputs.size()) + " values but a batch of " + std::to_string(count) + " takes " + std::to_string((size_t)count * this->getInputCount()));
+    }
+    if (this->_operators.empty()) {
+        outputs = inputs;
+        return;
+    }
+
+    size_t width = (size_t)this->getMaxWidth() * count;
+    outputs.resize(width);
+    scratch.resize(width);
+
+    double *buffers[2] = {outputs.data(), scratch.data()};
+    const double *source = inputs.data();
+    unsigned operators = this->_operators.size();
+    for (unsigned n = 0; n < operators; ++n) {
+        double *destination = buffers[(operators - 1 - n) & 1];
+        this->runBatch(this->_operators[n], source, destination, count);
+        source = destination;
+    }
+    outputs.resize((size_t)count * this->getOutputCount());
+}
+
+void Neural::OperatorGraph::runBatch(Operator const &op, const double *input, double *output, unsigned count) const {
+    if (op.type != Dense && op.type != MatMul) {
+        for (unsigned b = 0; b < count; ++b) {
+            this->run(op, input + (size_t)b * op.inputSize, output + (size_t)b * op.outputSize);
+        }
+        return;
+    }
+
+    // Four samples per pass share every weight load, each sum keeps the order of run()
+    unsigned in = op.inputSize;
+    unsigned out = op.outputSize;
+    bool tanhOutput = op.type == Dense && op.transfer == Tanh;
+    for (unsigned o = 0; o < out; ++o) {
+        const double *row = op.weights.data() + (size_t)o * in;
+        double bias = op.type == Dense ? op.bias[o] : 0.0;
+        unsigned b = 0;
+        for (; b + 4 <= count; b += 4) {
+            const double *x0 = input + (size_t)b * in;
+            const double *x1 = x0 + in;
+            const double *x2 = x1 + in;
+            const double *x3 = x2 + in;
+            double s0 = bias, s1 = bias, s2 = bias, s3 = bias;
+            for (unsigned i = 0; i < in; ++i) {
+                double w = row[i];
+                s0 += w * x0[i];
+                s1 += w * x1[i];
+                s2 += w * x2[i];
+                s3 += w * x3[i];
+            }
+            output[(size_t)b * out + o] = tanhOutput ? tanh(s0) : s0;
+            output[(size_t)(b + 1) * out + o] = tanhOutput ? tanh(s1) : s1;
+            output[(size_t)(b + 2) * out + o] = tanhOutput ? tanh(s2) : s2;
+            output[(size_t)(b + 3) * out + o] = tanhOutput ? tanh(s3) : s3;
+        }
+        for (; b < count; ++b) {
+            const double *x = input + (size_t)b * in;
+            double sum = bias;
+            for (unsigned i = 0; i < in; ++i) {
+                sum += row[i] * x[i];
+            }
+            output[(size_t)b * out + o] = tanhOutput ? tanh(sum) : sum;
+        }
+    }
+}
+
+void Neural::OperatorGraph::run(Operator const &op, const double *input, double *output) const {
+    switch (op.type) {
+    case Normalize:
+        for (unsigned i = 0; i < op.outputSize; ++i) {
+            output[i] = input[i] * op.weights[i] + op.bias[i];
+        }
+        break;
+    case MatMul:
+        for (unsigned o = 0; o < op.outputSize; ++o) {
+            const double *row = op.weights.data() + o * op.inputSize;
+            double sum = 0.0;
+            for (unsigned i = 0; i < op.inputSize; ++i) {
+                sum += row[i] * input[i];
+            }
+            output[o] = sum;
+        }
+        break;
+    case BiasAdd:
+        for (unsigned i = 0; i < op.outputSize; ++i) {
+            output[i] = input[i] + op.bias[i];
+        }
+        break;
+    case Activation:
+        for (unsigned i = 0; i < op.outputSize; ++i) {
+            output[i] = op.transfer == Tanh ? tanh(input[i]) : input[i];
+        }
+        break;
+    case Dense:
+        for (unsigned o = 0; o < op.outputSize; ++o) {
+            const double *row = op.weights.data() + o * op.inputSize;
+            double sum = op.bias[o];
+            for (unsigned i = 0; i < op.inputSize; ++i) {
+                sum += row[i] * input[i];
+            }
+            output[o] = op.transfer == Tanh ? tanh(sum) : sum;
+        }
+        break;
+    case Softmax: {
+        double max = *std::max_element(input, input + op.outputSize);
+        double sum = 0.0;
+        for (unsigned i = 0; i < op.outputSize; ++i) {
+            output[i] = exp(input[i] - max);
+            sum += output[i];
+        }
+        for (unsigned i = 0; i < op.outputSize; ++i) {
+            output[i] /= sum;
+        }
+        break;
+    }
+    }
+}
+
+void Neural::OperatorGraph::dump(std::ostream &os) const {
+    static const char *types[] = {"normalize", "matmul", "bias_add", "activation", "dense", "softmax"};
+    static const char *transfers[] = {"identity", "tanh"};
+
+    os << "graph: " << this->_operators.size() << " operator" << (this->_operators.size() > 1 ? "s" : "") << std::endl;
+    unsigned n = 0;
+    for (auto const &op: this->_operators) {
+        os << "\t%" << n << " = " << types[op.type] << " " << op.inputSize << " -> " << op.outputSize;
+        if (op.type == Activation || op.type == Dense)
+            os << " " << transfers[op.transfer];
+        os << std::endl;
+        n++;
+    }
+}
+
+std::vector<Neural::IOperatorGraph::Operator> const &Neural::OperatorGraph::getOperators() const {
+    return this->_operators;
+}
+
+unsigned Neural::OperatorGraph::getInputCount() const {
+    return this->_operators.empty() ? 0 : this->_operators.front().inputSize;
+}
+
+unsigned Neural::OperatorGraph::getOutputCount() const {
+    return this->_operators.empty() ? 0 : this->_operators.back().outputSize;
+}
+
+unsigned Neural::OperatorGraph::getMaxWidth() const {
+    unsigned width = 0;
+
+    for (auto const &op: this->_operators) {
+        width = std::max(width, std::max(op.inputSize, op.outputSize));
+    }
+    return width;
+}
+
+std::ostream &operator<<(std::ostream& os, const Neural::OperatorGraph &graph) {
+    graph.dump(os);
+    return os;
+}
@@ -0,0 +1,87 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   10/05/2018 16:20:12
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 10/05/2018 18:52:58
+ */
+
+
+#include "PoolingLayer.hpp"
+
+Neural::Shape Neural::PoolingLayer::outputShape(Shape const &inputShape, unsigned size) {
+    if (size == 0 || size > inputShape.height || size > inputShape.width)
+        throw Neural::InvalidTrainingFile("A " + std::to_string(size) + "x" + std::to_string(size) + " pooling does not fit a " + inputShape.toString() + " input");
+    return Neural::Shape{inputShape.channels, inputShape.height / size, inputShape.width / size};
+}
+
+Neural::PoolingLayer::PoolingLayer(Shape const &inputShape, unsigned size): ATransformLayer(inputShape, outputShape(inputShape, size)) {
+    this->_size = size;
+    this->_selected.assign(this->_outputShape.size(), 0);
+}
+
+Neural::PoolingLayer::~PoolingLayer() {
+
+}
+
+Neural::PoolingLayer::PoolingLayer(const PoolingLayer &layer): ATransformLayer(layer) {
+    this->_size = layer._size;
+    this->_selected = layer._selected;
+}
+
+Neural::PoolingLayer &Neural::PoolingLayer::operator =(const PoolingLayer &layer) {
+    Neural::ATransformLayer::operator=(layer);
+    this->_size = layer._size;
+    this->_selected = layer._selected;
+    return *this;
+}
+
+std::string Neural::PoolingLayer::getDescription() const {
+    return "pool:" + std::to_string(this->_size);
+}
+
+void Neural::PoolingLayer::feedForward(const std::vector<double> &input) {
+    this->checkInput(input);
+    this->pool(input.data(), this->_output.data(), this->_selected.data());
+}
+
+void Neural::PoolingLayer::predict(const std::vector<double> &input, std::vector<double> &output, std::vector<double> &) const {
+    this->checkInput(input);
+    output.resize(this->_outputShape.size());
+    this->pool(input.data(), output.data(), nullptr);
+}
+
+void Neural::PoolingLayer::pool(const double *input, double *output, unsigned *selected) const {
+    unsigned n = 0;
+    for (unsigned c = 0; c < this->_outputShape.channels; ++c) {
+        unsigned plane = c * this->_inputShape.height * this->_inputShape.width;
+        for (unsigned y = 0; y < this->_outputShape.height; ++y) {
+            for (unsigned x = 0; x < this->_outputShape.width; ++x) {
+                unsigned best = plane + y * this->_size * this->_inputShape.width + x * this->_size;
+                for (unsigned dy = 0; dy < this->_size; ++dy) {
+                    for (unsigned dx = 0; dx < this->_size; ++dx) {
+                        unsigned index = plane + (y * this->_size + dy) * this->_inputShape.width + x * this->_size + dx;
+                        if (input[index] > input[best])
+                            best = index;
+                    }
+                }
+                if (selected)
+                    selected[n] = best;
+                output[n] = input[best];
+                n++;
+            }
+        }
+    }
+}
+
+void Neural::PoolingLayer::backProp(const std::vector<double> &outputGradients) {
+    // Only the maximum of each window received the gradient
+    std::fill(this->_inputGradients.begin(), this->_inputGradients.end(), 0.0);
+    for (unsigned n = 0; n < this->_selected.size(); ++n) {
+        this->_inputGradients[this->_selected[n]] += outputGradients[n];
+    }
+}
+
+Neural::ITransformLayer *Neural::PoolingLayer::clone() const {
+    return new PoolingLayer(*this);
+}
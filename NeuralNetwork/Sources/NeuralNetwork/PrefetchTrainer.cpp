@@ -0,0 +1,196 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   24/05/2018 09:52:14
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 24/05/2018 17:20:36
+ */
+
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+
+#include "PrefetchTrainer.hpp"
+
+class Neural::PrefetchTrainer::Reader : public INetworkTrainer::IReader {
+
+public:
+    Reader(PrefetchTrainer const &trainer, std::unique_ptr<IReader> source): _trainer(trainer), _source(std::move(source)) {
+        this->_batches.resize(std::max(trainer._depth, 2u), std::vector<TrainingData>(std::max(trainer._batch, 1u)));
+        for (size_t n = 0; n < this->_batches.size(); ++n) {
+            this->_free.push_back(n);
+        }
+        this->_current = -1;
+        this->_count = 0;
+        this->_next = 0;
+        this->_over = false;
+        this->_stop = false;
+        this->_thread = std::thread(&Reader::load, this);
+    }
+
+    ~Reader() {
+        {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            this->_stop = true;
+        }
+        this->_condition.notify_all();
+        this->_thread.join();
+    }
+
+    const TrainingData *next() {
+        if (this->_current >= 0 && this->_next < this->_count)
+            return &this->_batches[this->_current][this->_next++];
+
+        std::unique_lock<std::mutex> lock(this->_mutex);
+        // The last sample handed out is not used anymore, its batch can be filled again
+        if (this->_current >= 0) {
+            this->_free.push_back(this->_current);
+            this->_current = -1;
+            this->_condition.notify_all();
+        }
+        bool stalled = this->_ready.empty() && !this->_over;
+        auto start = std::chrono::steady_clock::now();
+        this->_condition.wait(lock, [this]() { return !this->_ready.empty() || this->_over; });
+        double waited = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (this->_ready.empty()) {
+            if (this->_error)
+                std::rethrow_exception(this->_error);
+            return nullptr;
+        }
+        this->_current = this->_ready.front().first;
+        this->_count = this->_ready.front().second;
+        this->_next = 0;
+        this->_ready.pop_front();
+        lock.unlock();
+
+        std::lock_guard<std::mutex> statsLock(this->_trainer._mutex);
+        this->_trainer._stats.batches++;
+        if (stalled) {
+            this->_trainer._stats.stalls++;
+            this->_trainer._stats.stallSeconds += waited;
+        }
+        return &this->_batches[this->_current][this->_next++];
+    }
+
+private:
+    PrefetchTrainer const &_trainer;
+    std::unique_ptr<IReader> _source;
+    std::vector<std::vector<TrainingData>> _batches;
+    std::deque<int> _free;
+    std::deque<std::pair<int, size_t>> _ready;    // batch and its sample count, in the order of the pass
+    int _current;
+    size_t _count;
+    size_t _next;
+    bool _over;
+    bool _stop;
+    std::exception_ptr _error;
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    std::thread _thread;
+
+    // Fills the free batches with the samples of the source, until the pass is over
+    void load() {
+        while (true) {
+            int index;
+            {
+                std::unique_lock<std::mutex> lock(this->_mutex);
+                if (this->_free.empty() && !this->_stop) {
+                    std::lock_guard<std::mutex> statsLock(this->_trainer._mutex);
+                    this->_trainer._stats.loaderWaits++;
+                }
+                this->_condition.wait(lock, [this]() { return !this->_free.empty() || this->_stop; });
+                if (this->_stop)
+                    return;
+                index = this->_free.front();
+                this->_free.pop_front();
+            }
+
+            std::vector<TrainingData> &batch = this->_batches[index];
+            size_t count = 0;
+            bool over = false;
+            std::exception_ptr error;
+            try {
+                while (count < batch.size()) {
+                    const TrainingData *sample = this->_source->next();
+                    if (sample == nullptr) {
+                        over = true;
+                        break;
+                    }
+                    batch[count].input.assign(sample->input.begin(), sample->input.end());
+                    batch[count].output.assign(sample->output.begin(), sample->output.end());
+                    count++;
+                }
+            } catch (...) {
+                // Raised by next() once the samples read before it were trained on
+                error = std::current_exception();
+                over = true;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(this->_mutex);
+                if (count > 0)
+                    this->_ready.push_back(std::make_pair(index, count));
+                else
+                    this->_free.push_back(index);
+                this->_over = over;
+                this->_error = error;
+            }
+            this->_condition.notify_all();
+            if (over)
+                return;
+        }
+    }
+
+};
+
+Neural::PrefetchTrainer::PrefetchTrainer(INetworkTrainer &source, unsigned batch, unsigned depth) {
+    this->_debug = source.getDebugFLag();
+    this->_source = &source;
+    this->_batch = batch;
+    this->_depth = depth;
+}
+
+Neural::PrefetchTrainer::~PrefetchTrainer() {
+
+}
+
+Neural::PrefetchTrainer::PrefetchTrainer(const PrefetchTrainer &trainer) {
+    *this = trainer;
+}
+
+Neural::PrefetchTrainer &Neural::PrefetchTrainer::operator =(const PrefetchTrainer &trainer) {
+    this->_debug = trainer._debug;
+    this->_source = trainer._source;
+    this->_batch = trainer._batch;
+    this->_depth = trainer._depth;
+    this->_stats = trainer.getStats();
+    return *this;
+}
+
+Neural::Topology const &Neural::PrefetchTrainer::getTopology() const {
+    return this->_source->getTopology();
+}
+
+std::unique_ptr<Neural::INetworkTrainer::IReader> Neural::PrefetchTrainer::read() const {
+    return std::unique_ptr<IReader>(new Reader(*this, this->_source->read()));
+}
+
+void Neural::PrefetchTrainer::shuffle(Random &random) {
+    this->_source->shuffle(random);
+}
+
+void Neural::PrefetchTrainer::setDebugFLag(bool mode) {
+    this->_debug = mode;
+}
+
+bool Neural::PrefetchTrainer::getDebugFLag() const {
+    return this->_debug;
+}
+
+Neural::PrefetchTrainer::Stats Neural::PrefetchTrainer::getStats() const {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    return this->_stats;
+}
@@ -0,0 +1,93 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   14/05/2018 10:02:33
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 14/05/2018 17:48:12
+ */
+
+
+#include "Random.hpp"
+
+Neural::Random::Random(uint64_t seed, uint64_t stream) {
+    this->seed(seed, stream);
+}
+
+Neural::Random::~Random() {
+
+}
+
+Neural::Random::Random(const Random &random) {
+    this->_state = random._state;
+}
+
+Neural::Random &Neural::Random::operator =(const Random &random) {
+    this->_state = random._state;
+    return *this;
+}
+
+void Neural::Random::seed(uint64_t seed, uint64_t stream) {
+    // Mix the stream in first so that neighbour streams do not share any state word
+    uint64_t x = stream;
+    x = seed ^ splitMix(x);
+    for (auto &word: this->_state) {
+        word = splitMix(x);
+    }
+}
+
+uint64_t Neural::Random::next() {
+    uint64_t result = rotl(this->_state[1] * 5, 7) * 9;
+    uint64_t t = this->_state[1] << 17;
+
+    this->_state[2] ^= this->_state[0];
+    this->_state[3] ^= this->_state[1];
+    this->_state[1] ^= this->_state[2];
+    this->_state[0] ^= this->_state[3];
+    this->_state[2] ^= t;
+    this->_state[3] = rotl(this->_state[3], 45);
+    return result;
+}
+
+double Neural::Random::uniform() {
+    // 53 high bits, exactly representable
+    return (this->next() >> 11) * 0x1.0p-53;
+}
+
+double Neural::Random::uniform(double min, double max) {
+    return min + (max - min) * this->uniform();
+}
+
+double Neural::Random::normal() {
+    // Box-Muller, 1 - uniform() is never 0
+    double u = 1.0 - this->uniform();
+    double v = this->uniform();
+    return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+unsigned Neural::Random::below(unsigned bound) {
+    // Lemire's multiply and shift, the bias is under 2^-32
+    return (unsigned)(((this->next() >> 32) * bound) >> 32);
+}
+
+std::array<uint64_t, 4> const &Neural::Random::getState() const {
+    return this->_state;
+}
+
+void Neural::Random::setState(std::array<uint64_t, 4> const &state) {
+    this->_state = state;
+}
+
+uint64_t Neural::Random::hash(uint64_t key) {
+    return splitMix(key);
+}
+
+uint64_t Neural::Random::splitMix(uint64_t &x) {
+    uint64_t z = (x += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
+uint64_t Neural::Random::rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
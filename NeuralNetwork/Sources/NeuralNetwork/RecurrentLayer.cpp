@@ -0,0 +1,321 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   12/05/2018 10:14:45
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 12/05/2018 20:31:17
+ */
+
+
+#include "RecurrentLayer.hpp"
+
+Neural::Shape Neural::RecurrentLayer::outputShape(Shape const &inputShape, unsigned hidden) {
+    (void)inputShape;
+    if (hidden == 0)
+        throw Neural::InvalidTrainingFile("A recurrent layer needs at least one hidden unit");
+    return Neural::Shape{1, 1, hidden};
+}
+
+Neural::RecurrentLayer::RecurrentLayer(Shape const &inputShape, Cell cell, unsigned hidden, Random &random, unsigned bptt): ATransformLayer(inputShape, outputShape(inputShape, hidden)) {
+    this->_cell = cell;
+    this->_hidden = hidden;
+    this->_bptt = bptt;
+    this->_steps = inputShape.channels * inputShape.height;
+    this->_features = inputShape.width;
+    this->_gates = cell == LSTM ? 4 : 3;
+
+    // LSTM: [4 * hidden][features + hidden + 1], gates ordered input, forget, candidate, output
+    // GRU: [3 * hidden][features + 1] then [3 * hidden][hidden + 1], gates ordered reset, update, candidate
+    unsigned fanIn = this->_features + hidden;
+    unsigned count = cell == LSTM ? 4 * hidden * (fanIn + 1) : 3 * hidden * (this->_features + 1) + 3 * hidden * (hidden + 1);
+    for (unsigned n = 0; n < count; ++n) {
+        this->_parameters.push_back(Neural::INeuron::Connection{this->randomWeight(random, fanIn), 0.0});
+    }
+    if (cell == LSTM) {
+        // Start with an open forget gate
+        for (unsigned j = 0; j < hidden; ++j) {
+            this->_parameters[(hidden + j) * (fanIn + 1) + fanIn].weight = 1.0;
+        }
+    }
+
+    this->_activations.assign(this->_steps * this->_gates * hidden, 0.0);
+    this->_recurrent.assign(this->_steps * hidden, 0.0);
+    this->_cells.assign((this->_steps + 1) * hidden, 0.0);
+    this->_states.assign((this->_steps + 1) * hidden, 0.0);
+    this->_streamGates.assign(this->_gates * hidden, 0.0);
+    this->_streamRecurrent.assign(hidden, 0.0);
+    this->_preactivation.assign(this->_gates * hidden, 0.0);
+    this->_scratch.assign(this->_gates * hidden, 0.0);
+    this->resetState();
+}
+
+Neural::RecurrentLayer::~RecurrentLayer() {
+
+}
+
+Neural::RecurrentLayer::RecurrentLayer(const RecurrentLayer &layer): ATransformLayer(layer) {
+    *this = layer;
+}
+
+Neural::RecurrentLayer &Neural::RecurrentLayer::operator =(const RecurrentLayer &layer) {
+    Neural::ATransformLayer::operator=(layer);
+    this->_cell = layer._cell;
+    this->_hidden = layer._hidden;
+    this->_bptt = layer._bptt;
+    this->_steps = layer._steps;
+    this->_features = layer._features;
+    this->_gates = layer._gates;
+    this->_input = layer._input;
+    this->_activations = layer._activations;
+    this->_recurrent = layer._recurrent;
+    this->_cells = layer._cells;
+    this->_states = layer._states;
+    this->_streamCell = layer._streamCell;
+    this->_streamState = layer._streamState;
+    this->_streamGates = layer._streamGates;
+    this->_streamRecurrent = layer._streamRecurrent;
+    this->_preactivation = layer._preactivation;
+    this->_scratch = layer._scratch;
+    return *this;
+}
+
+std::string Neural::RecurrentLayer::getDescription() const {
+    std::string description = std::string(this->_cell == LSTM ? "lstm:" : "gru:") + std::to_string(this->_hidden);
+
+    if (this->_bptt != 0)
+        description += ":" + std::to_string(this->_bptt);
+    return description;
+}
+
+void Neural::RecurrentLayer::feedForward(const std::vector<double> &input) {
+    this->checkInput(input);
+    this->_input = input;
+
+    // Every sample is a whole sequence starting from a zero state
+    unsigned h = this->_hidden;
+    std::fill(this->_states.begin(), this->_states.begin() + h, 0.0);
+    std::fill(this->_cells.begin(), this->_cells.begin() + h, 0.0);
+    for (unsigned t = 0; t < this->_steps; ++t) {
+        this->forwardStep(this->_input.data() + t * this->_features,
+                          this->_states.data() + t * h, this->_cells.data() + t * h,
+                          this->_activations.data() + t * this->_gates * h, this->_recurrent.data() + t * h,
+                          this->_cells.data() + (t + 1) * h, this->_states.data() + (t + 1) * h,
+                          this->_preactivation.data(), this->_scratch.data());
+    }
+    std::copy(this->_states.end() - h, this->_states.end(), this->_output.begin());
+}
+
+void Neural::RecurrentLayer::backProp(const std::vector<double> &outputGradients) {
+    std::vector<double> gradients(this->_parameters.size(), 0.0);
+    unsigned from = this->_bptt == 0 || this->_bptt >= this->_steps ? 0 : this->_steps - this->_bptt;
+
+    std::fill(this->_inputGradients.begin(), this->_inputGradients.end(), 0.0);
+    if (this->_cell == LSTM)
+        this->backwardLSTM(from, outputGradients, gradients);
+    else
+        this->backwardGRU(from, outputGradients, gradients);
+
+    for (unsigned n = 0; n < gradients.size(); ++n) {
+        this->updateParameter(n, gradients[n]);
+    }
+}
+
+void Neural::RecurrentLayer::predict(const std::vector<double> &input, std::vector<double> &output, std::vector<double> &scratch) const {
+    this->checkInput(input);
+
+    // Only the running state is kept, [state][cell][gates][recurrent][input sums][state sums]
+    unsigned h = this->_hidden;
+    unsigned g = this->_gates * h;
+    scratch.assign(3 * h + 3 * g, 0.0);
+    double *state = scratch.data();
+    double *cell = state + h;
+    double *gates = cell + h;
+    double *recurrent = gates + g;
+    for (unsigned t = 0; t < this->_steps; ++t) {
+        this->forwardStep(input.data() + t * this->_features, state, cell, gates, recurrent, cell, state, recurrent + h, recurrent + h + g);
+    }
+    output.assign(state, state + h);
+}
+
+Neural::ITransformLayer *Neural::RecurrentLayer::clone() const {
+    return new RecurrentLayer(*this);
+}
+
+void Neural::RecurrentLayer::step(const std::vector<double> &frame) {
+    if (frame.size() != this->_features) {
+        throw Neural::InvalidInput("You want to stream " + std::to_string(frame.size()) + " values but the layer " + this->getDescription() + " reads " + std::to_string(this->_features) + " features per step");
+    }
+    this->forwardStep(frame.data(), this->_streamState.data(), this->_streamCell.data(),
+                      this->_streamGates.data(), this->_streamRecurrent.data(),
+                      this->_streamCell.data(), this->_streamState.data(),
+                      this->_preactivation.data(), this->_scratch.data());
+    std::copy(this->_streamState.begin(), this->_streamState.end(), this->_output.begin());
+}
+
+void Neural::RecurrentLayer::resetState() {
+    this->_streamCell.assign(this->_hidden, 0.0);
+    this->_streamState.assign(this->_hidden, 0.0);
+}
+
+unsigned Neural::RecurrentLayer::getFeatureCount() const {
+    return this->_features;
+}
+
+void Neural::RecurrentLayer::forwardStep(const double *x, const double *prevState, const double *prevCell, double *gates, double *recurrent, double *cell, double *state, double *inputSums, double *stateSums) const {
+    unsigned f = this->_features;
+    unsigned h = this->_hidden;
+    const Neural::INeuron::Connection *w = this->_parameters.data();
+
+    if (this->_cell == LSTM) {
+        // All four gates in one product over [x, h, 1]
+        unsigned columns = f + h + 1;
+        for (unsigned row = 0; row < 4 * h; ++row) {
+            const Neural::INeuron::Connection *weights = w + row * columns;
+            double sum = weights[f + h].weight;
+            for (unsigned k = 0; k < f; ++k) {
+                sum += weights[k].weight * x[k];
+            }
+            for (unsigned k = 0; k < h; ++k) {
+                sum += weights[f + k].weight * prevState[k];
+            }
+            inputSums[row] = sum;
+        }
+        for (unsigned j = 0; j < h; ++j) {
+            double i = gates[j] = this->sigmoid(inputSums[j]);
+            double fg = gates[h + j] = this->sigmoid(inputSums[h + j]);
+            double g = gates[2 * h + j] = tanh(inputSums[2 * h + j]);
+            double o = gates[3 * h + j] = this->sigmoid(inputSums[3 * h + j]);
+            cell[j] = fg * prevCell[j] + i * g;
+            state[j] = o * tanh(cell[j]);
+        }
+        return;
+    }
+
+    // GRU, gates of the input then of the previous state
+    const Neural::INeuron::Connection *recurrentWeights = w + 3 * h * (f + 1);
+    for (unsigned row = 0; row < 3 * h; ++row) {
+        const Neural::INeuron::Connection *weights = w + row * (f + 1);
+        double sum = weights[f].weight;
+        for (unsigned k = 0; k < f; ++k) {
+            sum += weights[k].weight * x[k];
+        }
+        inputSums[row] = sum;
+
+        weights = recurrentWeights + row * (h + 1);
+        sum = weights[h].weight;
+        for (unsigned k = 0; k < h; ++k) {
+            sum += weights[k].weight * prevState[k];
+        }
+        stateSums[row] = sum;
+    }
+    for (unsigned j = 0; j < h; ++j) {
+        double r = gates[j] = this->sigmoid(inputSums[j] + stateSums[j]);
+        double z = gates[h + j] = this->sigmoid(inputSums[h + j] + stateSums[h + j]);
+        recurrent[j] = stateSums[2 * h + j];
+        double n = gates[2 * h + j] = tanh(inputSums[2 * h + j] + r * recurrent[j]);
+        state[j] = (1.0 - z) * n + z * prevState[j];
+    }
+}
+
+void Neural::RecurrentLayer::backwardLSTM(unsigned from, const std::vector<double> &outputGradients, std::vector<double> &gradients) {
+    unsigned f = this->_features;
+    unsigned h = this->_hidden;
+    unsigned columns = f + h + 1;
+    std::vector<double> stateGradient(outputGradients);
+    std::vector<double> cellGradient(h, 0.0);
+    std::vector<double> &gateGradient = this->_preactivation;
+
+    for (unsigned t = this->_steps; t-- > from;) {
+        const double *gates = this->_activations.data() + t * 4 * h;
+        const double *cell = this->_cells.data() + (t + 1) * h;
+        const double *prevCell = this->_cells.data() + t * h;
+        const double *prevState = this->_states.data() + t * h;
+        const double *x = this->_input.data() + t * f;
+
+        for (unsigned j = 0; j < h; ++j) {
+            double i = gates[j], fg = gates[h + j], g = gates[2 * h + j], o = gates[3 * h + j];
+            double tc = tanh(cell[j]);
+            double dc = cellGradient[j] + stateGradient[j] * o * (1.0 - tc * tc);
+            gateGradient[j] = dc * g * i * (1.0 - i);
+            gateGradient[h + j] = dc * prevCell[j] * fg * (1.0 - fg);
+            gateGradient[2 * h + j] = dc * i * (1.0 - g * g);
+            gateGradient[3 * h + j] = stateGradient[j] * tc * o * (1.0 - o);
+            cellGradient[j] = dc * fg;
+        }
+
+        // One pass over the fused matrix: weight gradients and gradients of [x, h]
+        std::fill(stateGradient.begin(), stateGradient.end(), 0.0);
+        double *inputGradient = this->_inputGradients.data() + t * f;
+        for (unsigned row = 0; row < 4 * h; ++row) {
+            const Neural::INeuron::Connection *weights = this->_parameters.data() + row * columns;
+            double *gradient = gradients.data() + row * columns;
+            double dz = gateGradient[row];
+            for (unsigned k = 0; k < f; ++k) {
+                gradient[k] += dz * x[k];
+                inputGradient[k] += weights[k].weight * dz;
+            }
+            for (unsigned k = 0; k < h; ++k) {
+                gradient[f + k] += dz * prevState[k];
+                stateGradient[k] += weights[f + k].weight * dz;
+            }
+            gradient[f + h] += dz;
+        }
+    }
+}
+
+void Neural::RecurrentLayer::backwardGRU(unsigned from, const std::vector<double> &outputGradients, std::vector<double> &gradients) {
+    unsigned f = this->_features;
+    unsigned h = this->_hidden;
+    unsigned offset = 3 * h * (f + 1);
+    std::vector<double> stateGradient(outputGradients);
+    std::vector<double> prevStateGradient(h, 0.0);
+    std::vector<double> &inputGateGradient = this->_preactivation;
+    std::vector<double> &stateGateGradient = this->_scratch;
+
+    for (unsigned t = this->_steps; t-- > from;) {
+        const double *gates = this->_activations.data() + t * 3 * h;
+        const double *recurrent = this->_recurrent.data() + t * h;
+        const double *prevState = this->_states.data() + t * h;
+        const double *x = this->_input.data() + t * f;
+
+        for (unsigned j = 0; j < h; ++j) {
+            double r = gates[j], z = gates[h + j], n = gates[2 * h + j];
+            double dn = stateGradient[j] * (1.0 - z) * (1.0 - n * n);
+            double dr = dn * recurrent[j] * r * (1.0 - r);
+            double dz = stateGradient[j] * (prevState[j] - n) * z * (1.0 - z);
+            inputGateGradient[j] = dr;
+            inputGateGradient[h + j] = dz;
+            inputGateGradient[2 * h + j] = dn;
+            stateGateGradient[j] = dr;
+            stateGateGradient[h + j] = dz;
+            stateGateGradient[2 * h + j] = dn * r;
+            prevStateGradient[j] = stateGradient[j] * z;
+        }
+
+        double *inputGradient = this->_inputGradients.data() + t * f;
+        for (unsigned row = 0; row < 3 * h; ++row) {
+            const Neural::INeuron::Connection *weights = this->_parameters.data() + row * (f + 1);
+            double *gradient = gradients.data() + row * (f + 1);
+            double dz = inputGateGradient[row];
+            for (unsigned k = 0; k < f; ++k) {
+                gradient[k] += dz * x[k];
+                inputGradient[k] += weights[k].weight * dz;
+            }
+            gradient[f] += dz;
+
+            weights = this->_parameters.data() + offset + row * (h + 1);
+            gradient = gradients.data() + offset + row * (h + 1);
+            dz = stateGateGradient[row];
+            for (unsigned k = 0; k < h; ++k) {
+                gradient[k] += dz * prevState[k];
+                prevStateGradient[k] += weights[k].weight * dz;
+            }
+            gradient[h] += dz;
+        }
+        stateGradient.swap(prevStateGradient);
+    }
+}
+
+double Neural::RecurrentLayer::sigmoid(double x) const {
+    return 1.0 / (1.0 + exp(-x));
+}
@@ -0,0 +1,185 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   17/05/2018 18:21:05
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 18/05/2018 11:47:36
+ */
+
+
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "SampleStream.hpp"
+
+Neural::SampleStream::SampleStream(int fd) {
+    this->_fd = fd;
+    this->_server = -1;
+    this->_buffer.resize(1 << 16);
+    this->_begin = 0;
+    this->_end = 0;
+    this->_hasTopology = false;
+    this->_rejected = 0;
+}
+
+Neural::SampleStream::SampleStream(std::string const &socketPath): SampleStream(-1) {
+    sockaddr_un address;
+    if (socketPath.size() >= sizeof(address.sun_path))
+        throw Neural::InvalidTrainingFile("The socket path " + socketPath + " is too long");
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socketPath.c_str());
+
+    this->_server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (this->_server < 0)
+        throw Neural::InvalidTrainingFile("Could not create a socket: " + std::string(strerror(errno)));
+    unlink(socketPath.c_str());
+    if (bind(this->_server, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 || listen(this->_server, 8) < 0) {
+        std::string error = strerror(errno);
+        close(this->_server);
+        throw Neural::InvalidTrainingFile("Could not listen on " + socketPath + ": " + error);
+    }
+    this->_socketPath = socketPath;
+}
+
+Neural::SampleStream::~SampleStream() {
+    if (this->_server >= 0) {
+        if (this->_fd >= 0)
+            close(this->_fd);
+        close(this->_server);
+        unlink(this->_socketPath.c_str());
+    }
+}
+
+bool Neural::SampleStream::next(INetworkTrainer::TrainingData &data) {
+    std::string line;
+    std::string label;
+    std::vector<double> values;
+
+    while (this->readLine(line)) {
+        if (!parse(line, label, values))
+            continue;
+        if (label == "topology:") {
+            if (!this->_hasTopology) {
+                this->_topology = Topology(line.substr(line.find(':') + 1));
+                this->_hasTopology = true;
+            }
+        } else if (label == "in:") {
+            if (!this->_pending.empty())
+                this->_rejected++;
+            this->_pending.swap(values);
+            if (this->_pending.empty())
+                this->_rejected++;
+        } else if (label == "out:" && !this->_pending.empty() && !values.empty()) {
+            data.input.swap(this->_pending);
+            data.output.swap(values);
+            this->_pending.clear();
+            return true;
+        } else {
+            this->_rejected++;
+        }
+    }
+    return false;
+}
+
+Neural::Topology const &Neural::SampleStream::readTopology() {
+    std::string line;
+    std::string label;
+    std::vector<double> values;
+
+    while (!this->_hasTopology) {
+        if (!this->readLine(line))
+            throw Neural::InvalidTrainingFile("The stream ended before its topology brief");
+        if (!parse(line, label, values))
+            continue;
+        if (label != "topology:")
+            throw Neural::InvalidTrainingFile("The stream does not start with a topology brief");
+        this->_topology = Topology(line.substr(line.find(':') + 1));
+        this->_hasTopology = true;
+    }
+    return this->_topology;
+}
+
+bool Neural::SampleStream::hasTopology() const {
+    return this->_hasTopology;
+}
+
+void Neural::SampleStream::reject() {
+    this->_rejected++;
+}
+
+unsigned long Neural::SampleStream::getRejected() const {
+    return this->_rejected;
+}
+
+bool Neural::SampleStream::readLine(std::string &line) {
+    line.clear();
+    while (true) {
+        char *begin = this->_buffer.data() + this->_begin;
+        char *newline = static_cast<char *>(memchr(begin, '\n', this->_end - this->_begin));
+        if (newline) {
+            line.append(begin, newline);
+            this->_begin = newline - this->_buffer.data() + 1;
+            return true;
+        }
+        line.append(begin, this->_end - this->_begin);
+        this->_begin = this->_end = 0;
+        if (!this->fill()) {
+            // The last line of stdin may miss its newline, a client that left mid-line sent a cut one
+            if (!line.empty() && this->_server < 0)
+                return true;
+            // A record cut by the end of its connection is dropped
+            if (!this->_pending.empty() || !line.empty())
+                this->_rejected++;
+            this->_pending.clear();
+            line.clear();
+            if (this->_server < 0)
+                return false;
+        }
+    }
+}
+
+bool Neural::SampleStream::fill() {
+    while (true) {
+        if (this->_fd < 0) {
+            this->_fd = accept(this->_server, nullptr, nullptr);
+            if (this->_fd < 0) {
+                if (errno == EINTR)
+                    continue;
+                throw Neural::InvalidTrainingFile("Could not accept a client on " + this->_socketPath + ": " + strerror(errno));
+            }
+        }
+        ssize_t count = read(this->_fd, this->_buffer.data(), this->_buffer.size());
+        if (count > 0) {
+            this->_end = count;
+            return true;
+        }
+        if (count < 0 && errno == EINTR)
+            continue;
+        // End of the input, a socket client left
+        if (this->_server >= 0) {
+            close(this->_fd);
+            this->_fd = -1;
+        }
+        return false;
+    }
+}
+
+bool Neural::SampleStream::parse(std::string const &line, std::string &label, std::vector<double> &values) {
+    std::stringstream ss(line);
+
+    label.clear();
+    values.clear();
+    if (!(ss >> label))
+        return false;
+    if (label == "topology:")
+        return true;
+    double oneValue;
+    while (ss >> oneValue) {
+        values.push_back(oneValue);
+    }
+    return true;
+}
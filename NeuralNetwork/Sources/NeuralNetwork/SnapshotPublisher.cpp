@@ -0,0 +1,98 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   16/05/2018 10:12:27
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 16/05/2018 19:33:45
+ */
+
+
+#include "SnapshotPublisher.hpp"
+
+Neural::SnapshotPublisher::Reader::Reader(Slot *slot) {
+    this->_slot = slot;
+}
+
+Neural::SnapshotPublisher::Reader::~Reader() {
+    if (this->_slot)
+        this->_slot->readers.fetch_sub(1);
+}
+
+Neural::SnapshotPublisher::Reader::Reader(Reader &&reader) {
+    this->_slot = reader._slot;
+    reader._slot = nullptr;
+}
+
+Neural::OperatorGraph const &Neural::SnapshotPublisher::Reader::operator *() const {
+    return *this->_slot->graph;
+}
+
+Neural::OperatorGraph const *Neural::SnapshotPublisher::Reader::operator ->() const {
+    return this->_slot->graph.get();
+}
+
+Neural::SnapshotPublisher::Reader::operator bool() const {
+    return this->_slot && this->_slot->graph;
+}
+
+uint64_t Neural::SnapshotPublisher::Reader::getVersion() const {
+    return this->_slot->version;
+}
+
+Neural::SnapshotPublisher::SnapshotPublisher() {
+    for (auto &slot: this->_slots) {
+        slot.readers = 0;
+        slot.version = 0;
+    }
+    this->_current = 0;
+    this->_version = 0;
+}
+
+Neural::SnapshotPublisher::~SnapshotPublisher() {
+
+}
+
+void Neural::SnapshotPublisher::publish(ANetworkData const &network) {
+    std::shared_ptr<OperatorGraph> graph = std::make_shared<OperatorGraph>(network);
+
+    graph->fuse();
+    this->publish(std::shared_ptr<const OperatorGraph>(graph));
+}
+
+void Neural::SnapshotPublisher::publish(std::shared_ptr<const OperatorGraph> const &graph) {
+    std::lock_guard<std::mutex> lock(this->_writer);
+    unsigned next = 1 - this->_current.load();
+    Slot &slot = this->_slots[next];
+
+    // Grace period: the readers of the previous snapshot finish with it
+    while (slot.readers.load() != 0) {
+        std::this_thread::yield();
+    }
+    slot.graph = graph;
+    slot.version = ++this->_version;
+    this->_current.store(next);
+}
+
+Neural::SnapshotPublisher::Reader Neural::SnapshotPublisher::acquire() const {
+    while (true) {
+        unsigned current = this->_current.load();
+        Slot &slot = this->_slots[current];
+        slot.readers.fetch_add(1);
+        // The writer may have flipped in between, this slot could then be rewritten
+        if (this->_current.load() == current)
+            return Reader(&slot);
+        slot.readers.fetch_sub(1);
+    }
+}
+
+void Neural::SnapshotPublisher::predict(const std::vector<double> &input, std::vector<double> &output, std::vector<double> &scratch) const {
+    Reader snapshot = this->acquire();
+
+    if (!snapshot)
+        throw Neural::NetworkException("No network snapshot has been published yet");
+    snapshot->execute(input, output, scratch);
+}
+
+uint64_t Neural::SnapshotPublisher::getVersion() const {
+    return this->acquire().getVersion();
+}
@@ -0,0 +1,98 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   21/05/2018 10:21:37
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 21/05/2018 17:48:05
+ */
+
+
+#include <algorithm>
+
+#include "StreamingTrainer.hpp"
+#include "DatasetParser.hpp"
+
+class Neural::StreamingTrainer::Reader : public INetworkTrainer::IReader {
+
+public:
+    Reader(std::string const &filename, unsigned window, bool shuffle, uint64_t seed): _parser(filename), _random(seed) {
+        this->_shuffle = shuffle;
+        this->_samples.resize(shuffle ? std::max(window, 1u) : 1);
+        this->_count = 0;
+        this->_next = 0;
+    }
+
+    const TrainingData *next() {
+        if (this->_next == this->_count) {
+            this->_count = 0;
+            this->_next = 0;
+            while (this->_count < this->_samples.size() && this->_parser.next(this->_samples[this->_count].input, this->_samples[this->_count].output)) {
+                this->_count++;
+            }
+            // Fisher-Yates within the window
+            for (size_t n = this->_shuffle ? this->_count : 0; n > 1; --n) {
+                std::swap(this->_samples[n - 1], this->_samples[this->_random.below(n)]);
+            }
+            if (this->_count == 0)
+                return nullptr;
+        }
+        return &this->_samples[this->_next++];
+    }
+
+private:
+    DatasetParser _parser;
+    bool _shuffle;
+    Random _random;
+    std::vector<TrainingData> _samples;
+    size_t _count;
+    size_t _next;
+
+};
+
+Neural::StreamingTrainer::StreamingTrainer(std::string const &filename, unsigned window) {
+    this->_debug = false;
+    this->_filename = filename;
+    this->_window = window;
+    this->_shuffle = false;
+    this->_shuffleSeed = 0;
+    this->_topology = DatasetParser(filename).getTopology();
+}
+
+Neural::StreamingTrainer::~StreamingTrainer() {
+
+}
+
+Neural::StreamingTrainer::StreamingTrainer(const StreamingTrainer &trainer) {
+    *this = trainer;
+}
+
+Neural::StreamingTrainer &Neural::StreamingTrainer::operator =(const StreamingTrainer &trainer) {
+    this->_debug = trainer._debug;
+    this->_filename = trainer._filename;
+    this->_topology = trainer._topology;
+    this->_window = trainer._window;
+    this->_shuffle = trainer._shuffle;
+    this->_shuffleSeed = trainer._shuffleSeed;
+    return *this;
+}
+
+Neural::Topology const &Neural::StreamingTrainer::getTopology() const {
+    return this->_topology;
+}
+
+std::unique_ptr<Neural::INetworkTrainer::IReader> Neural::StreamingTrainer::read() const {
+    return std::unique_ptr<IReader>(new Reader(this->_filename, this->_window, this->_shuffle, this->_shuffleSeed));
+}
+
+void Neural::StreamingTrainer::shuffle(Random &random) {
+    this->_shuffle = true;
+    this->_shuffleSeed = random.next();
+}
+
+void Neural::StreamingTrainer::setDebugFLag(bool mode) {
+    this->_debug = mode;
+}
+
+bool Neural::StreamingTrainer::getDebugFLag() const {
+    return this->_debug;
+}
@@ -0,0 +1,85 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   14/05/2018 13:51:06
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 14/05/2018 17:49:02
+ */
+
+
+#include "ThreadPool.hpp"
+
+Neural::ThreadPool::ThreadPool(unsigned threads) {
+    this->_stop = false;
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned n = 0; n < threads; ++n) {
+        this->_threads.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+Neural::ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_stop = true;
+    }
+    this->_condition.notify_all();
+    for (auto &thread: this->_threads) {
+        thread.join();
+    }
+}
+
+std::future<void> Neural::ThreadPool::submit(std::function<void()> const &task) {
+    std::packaged_task<void()> packaged(task);
+    std::future<void> future = packaged.get_future();
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_tasks.push(std::move(packaged));
+    }
+    this->_condition.notify_one();
+    return future;
+}
+
+void Neural::ThreadPool::parallelFor(unsigned count, std::function<void(unsigned begin, unsigned end)> const &task) {
+    unsigned ranges = std::min(count, (unsigned)this->_threads.size());
+    if (ranges <= 1) {
+        task(0, count);
+        return;
+    }
+
+    // The caller runs the first range itself
+    std::vector<std::future<void>> futures;
+    for (unsigned n = 1; n < ranges; ++n) {
+        unsigned begin = (unsigned long)count * n / ranges;
+        unsigned end = (unsigned long)count * (n + 1) / ranges;
+        futures.push_back(this->submit([&task, begin, end]() { task(begin, end); }));
+    }
+    task(0, count / ranges);
+    for (auto &future: futures) {
+        future.get();
+    }
+}
+
+unsigned Neural::ThreadPool::getThreadCount() const {
+    return this->_threads.size();
+}
+
+Neural::ThreadPool &Neural::ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void Neural::ThreadPool::work() {
+    while (true) {
+        std::packaged_task<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(this->_mutex);
+            this->_condition.wait(lock, [this]() { return this->_stop || !this->_tasks.empty(); });
+            if (this->_stop && this->_tasks.empty())
+                return;
+            task = std::move(this->_tasks.front());
+            this->_tasks.pop();
+        }
+        task();
+    }
+}
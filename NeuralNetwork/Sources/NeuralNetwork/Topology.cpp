@@ -0,0 +1,283 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   10/05/2018 11:05:19
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 10/05/2018 18:53:06
+ */
+
+
+#include "Topology.hpp"
+#include "ConvolutionLayer.hpp"
+#include "PoolingLayer.hpp"
+#include "RecurrentLayer.hpp"
+#include "EmbeddingLayer.hpp"
+
+static Neural::ConvolutionLayer::Algorithm convolutionAlgorithm(std::vector<std::string> const &fields) {
+    if (fields.size() == 4 && fields[3] == "gemm")
+        return Neural::ConvolutionLayer::Gemm;
+    if (fields.size() == 4 && fields[3] == "direct")
+        return Neural::ConvolutionLayer::Direct;
+    return Neural::ConvolutionLayer::Auto;
+}
+
+Neural::Topology::Topology() {
+    this->_inputShape = Shape{1, 1, 0};
+    this->_loss = RMS;
+}
+
+Neural::Topology::Topology(std::vector<unsigned> const &layers, Loss loss) {
+    this->_layers = layers;
+    this->_dropout.assign(layers.size(), 0.0);
+    this->_batchNorm.assign(layers.size(), false);
+    this->_loss = loss;
+    this->_inputShape = Shape{1, 1, layers.empty() ? 0 : layers.front()};
+}
+
+Neural::Topology::Topology(std::string const &description) {
+    std::vector<std::string> tokens;
+    std::stringstream ss(description);
+    std::string token;
+
+    while (ss >> token) {
+        tokens.push_back(token);
+    }
+    if (tokens.empty())
+        throw Neural::InvalidTrainingFile("Your topology brief is empty");
+    this->_loss = RMS;
+    if (tokens.back() == "softmax") {
+        this->_loss = SoftmaxCrossEntropy;
+        tokens.pop_back();
+    }
+    if (tokens.empty())
+        throw Neural::InvalidTrainingFile("Your topology brief has no layer before softmax");
+
+    unsigned n = 0;
+    if (!isNumber(tokens[0])) {
+        // Leading input shape, then the transform layers
+        this->_inputShape = Shape::parse(tokens[n++]);
+        Shape shape = this->_inputShape;
+        while (n < tokens.size() && !isNumber(tokens[n]) && !isDropout(tokens[n]) && tokens[n] != "batchnorm") {
+            shape = transformShape(tokens[n], shape);
+            this->_transforms.push_back(tokens[n++]);
+        }
+        this->_layers.push_back(shape.size());
+        if (n == tokens.size())
+            throw Neural::InvalidTrainingFile("Your topology brief needs at least one fully connected layer after " + tokens.back());
+    }
+    for (; n < tokens.size(); ++n) {
+        if (isDropout(tokens[n]) && !this->_layers.empty()) {
+            this->_dropout.resize(this->_layers.size(), 0.0);
+            this->_dropout.back() = dropoutRate(tokens[n]);
+            continue;
+        }
+        if (tokens[n] == "batchnorm" && this->_layers.size() > 1) {
+            this->_batchNorm.resize(this->_layers.size(), false);
+            this->_batchNorm.back() = true;
+            continue;
+        }
+        if (tokens[n] == "batchnorm")
+            throw Neural::InvalidTrainingFile("batchnorm applies to the sums of a fully connected layer, it cannot follow the input layer");
+        if (!isNumber(tokens[n]))
+            throw Neural::InvalidTrainingFile("Unexpected " + tokens[n] + " in topology brief, transform layers must come before the fully connected layers");
+        this->_layers.push_back(std::stoul(tokens[n]));
+    }
+    this->_dropout.resize(this->_layers.size(), 0.0);
+    this->_batchNorm.resize(this->_layers.size(), false);
+    if (this->_dropout.back() != 0.0)
+        throw Neural::InvalidTrainingFile("Dropout cannot be applied to the output layer");
+    if (this->_transforms.empty())
+        this->_inputShape = Shape{1, 1, this->_layers.front()};
+    if (this->_loss == SoftmaxCrossEntropy && (this->_layers.size() < 2 || this->_layers.back() < 2))
+        throw Neural::InvalidTrainingFile("A softmax output needs at least 2 output neurons");
+}
+
+Neural::Topology::Topology(Shape const &inputShape, std::vector<std::string> const &transforms, std::vector<unsigned> const &layers, Loss loss) {
+    this->_inputShape = inputShape;
+    this->_transforms = transforms;
+    this->_layers = layers;
+    this->_dropout.assign(layers.size(), 0.0);
+    this->_batchNorm.assign(layers.size(), false);
+    this->_loss = loss;
+}
+
+Neural::Topology::~Topology() {
+
+}
+
+Neural::Topology::Topology(const Topology &topology) {
+    this->_inputShape = topology._inputShape;
+    this->_transforms = topology._transforms;
+    this->_layers = topology._layers;
+    this->_dropout = topology._dropout;
+    this->_batchNorm = topology._batchNorm;
+    this->_loss = topology._loss;
+}
+
+Neural::Topology &Neural::Topology::operator =(const Topology &topology) {
+    this->_inputShape = topology._inputShape;
+    this->_transforms = topology._transforms;
+    this->_layers = topology._layers;
+    this->_dropout = topology._dropout;
+    this->_batchNorm = topology._batchNorm;
+    this->_loss = topology._loss;
+    return *this;
+}
+
+std::vector<unsigned> const &Neural::Topology::getLayers() const {
+    return this->_layers;
+}
+
+std::vector<std::string> const &Neural::Topology::getTransforms() const {
+    return this->_transforms;
+}
+
+Neural::Shape const &Neural::Topology::getInputShape() const {
+    return this->_inputShape;
+}
+
+unsigned Neural::Topology::getInputCount() const {
+    return this->_inputShape.size();
+}
+
+unsigned Neural::Topology::getOutputCount() const {
+    return this->_layers.empty() ? 0 : this->_layers.back();
+}
+
+Neural::Topology::Loss Neural::Topology::getLoss() const {
+    return this->_loss;
+}
+
+std::vector<double> const &Neural::Topology::getDropout() const {
+    return this->_dropout;
+}
+
+void Neural::Topology::setDropout(std::vector<double> const &dropout) {
+    if (dropout.size() != this->_layers.size() || (!dropout.empty() && dropout.back() != 0.0))
+        throw Neural::NetworkException("Dropout needs one rate per layer and none on the output layer");
+    this->_dropout = dropout;
+}
+
+std::string Neural::Topology::toString() const {
+    std::stringstream ss;
+
+    if (this->_transforms.empty()) {
+        for (unsigned n = 0; n < this->_layers.size(); ++n) {
+            ss << (n ? " " : "") << this->_layers[n];
+            if (this->_batchNorm[n])
+                ss << " batchnorm";
+            if (this->_dropout[n] != 0.0)
+                ss << " dropout:" << this->_dropout[n];
+        }
+    } else {
+        ss << this->_inputShape.toString();
+        for (auto const &transform: this->_transforms) {
+            ss << " " << transform;
+        }
+        for (unsigned n = 0; n < this->_layers.size(); ++n) {
+            if (n)
+                ss << " " << this->_layers[n];
+            if (this->_batchNorm[n])
+                ss << " batchnorm";
+            if (this->_dropout[n] != 0.0)
+                ss << " dropout:" << this->_dropout[n];
+        }
+    }
+    if (this->_loss == SoftmaxCrossEntropy)
+        ss << " softmax";
+    return ss.str();
+}
+
+std::vector<std::unique_ptr<Neural::ITransformLayer>> Neural::Topology::createTransforms(Random &random) const {
+    std::vector<std::unique_ptr<ITransformLayer>> transforms;
+    Shape shape = this->_inputShape;
+
+    for (auto const &description: this->_transforms) {
+        transforms.push_back(createTransform(description, shape, random));
+        shape = transforms.back()->getOutputShape();
+    }
+    return transforms;
+}
+
+std::unique_ptr<Neural::ITransformLayer> Neural::Topology::createTransform(std::string const &description, Shape const &inputShape, Random &random) {
+    std::vector<std::string> fields = transformFields(description);
+
+    if (fields[0] == "conv")
+        return std::unique_ptr<ITransformLayer>(new ConvolutionLayer(inputShape, parameter(fields, 1), parameter(fields, 2), random, convolutionAlgorithm(fields)));
+    if (fields[0] == "pool")
+        return std::unique_ptr<ITransformLayer>(new PoolingLayer(inputShape, parameter(fields, 1)));
+    if (fields[0] == "embed")
+        return std::unique_ptr<ITransformLayer>(new EmbeddingLayer(inputShape, parameter(fields, 1), parameter(fields, 2), random));
+    RecurrentLayer::Cell cell = fields[0] == "lstm" ? RecurrentLayer::LSTM : RecurrentLayer::GRU;
+    return std::unique_ptr<ITransformLayer>(new RecurrentLayer(inputShape, cell, parameter(fields, 1), random, fields.size() == 3 ? parameter(fields, 2) : 0));
+}
+
+Neural::Shape Neural::Topology::transformShape(std::string const &description, Shape const &inputShape) {
+    std::vector<std::string> fields = transformFields(description);
+
+    if (fields[0] == "conv")
+        return ConvolutionLayer::outputShape(inputShape, parameter(fields, 1), parameter(fields, 2));
+    if (fields[0] == "pool")
+        return PoolingLayer::outputShape(inputShape, parameter(fields, 1));
+    if (fields[0] == "embed")
+        return EmbeddingLayer::outputShape(inputShape, parameter(fields, 1), parameter(fields, 2));
+    return RecurrentLayer::outputShape(inputShape, parameter(fields, 1));
+}
+
+std::vector<std::string> Neural::Topology::transformFields(std::string const &description) {
+    std::vector<std::string> fields;
+    std::stringstream ss(description);
+    std::string field;
+
+    while (getline(ss, field, ':')) {
+        fields.push_back(field);
+    }
+
+    bool known = !fields.empty() && ((fields[0] == "conv" && (fields.size() == 3 || fields.size() == 4))
+        || (fields[0] == "pool" && fields.size() == 2)
+        || ((fields[0] == "lstm" || fields[0] == "gru") && (fields.size() == 2 || fields.size() == 3))
+        || (fields[0] == "embed" && fields.size() == 3));
+    if (!known)
+        throw Neural::InvalidTrainingFile("Unknown layer " + description + " in topology brief, expected conv:<filters>:<kernel>[:gemm|:direct], pool:<size>, lstm:<hidden>[:<bptt>], gru:<hidden>[:<bptt>] or embed:<vocabulary>:<dimension>");
+    for (unsigned n = 1; n < (fields[0] == "conv" ? 3 : fields.size()); ++n) {
+        parameter(fields, n);
+    }
+    if (fields[0] == "conv" && fields.size() == 4 && fields[3] != "gemm" && fields[3] != "direct")
+        throw Neural::InvalidTrainingFile("Unknown convolution algorithm " + fields[3] + " in " + description + ", use gemm or direct");
+    if (fields[0] == "conv" && convolutionAlgorithm(fields) == ConvolutionLayer::Direct && parameter(fields, 2) != 3)
+        throw Neural::InvalidTrainingFile("The direct convolution of " + description + " only supports 3x3 kernels, use gemm");
+    return fields;
+}
+
+unsigned Neural::Topology::parameter(std::vector<std::string> const &fields, unsigned index) {
+    if (index >= fields.size() || !isNumber(fields[index]))
+        throw Neural::InvalidTrainingFile("Invalid parameter " + std::to_string(index) + " for the " + fields[0] + " layer in topology brief");
+    return std::stoul(fields[index]);
+}
+
+std::vector<bool> const &Neural::Topology::getBatchNorm() const {
+    return this->_batchNorm;
+}
+
+void Neural::Topology::setBatchNorm(std::vector<bool> const &batchNorm) {
+    if (batchNorm.size() != this->_layers.size() || (!batchNorm.empty() && batchNorm.front()))
+        throw Neural::NetworkException("Batch normalization needs one flag per layer and none on the input layer");
+    this->_batchNorm = batchNorm;
+}
+
+bool Neural::Topology::isDropout(std::string const &token) {
+    return token.compare(0, 8, "dropout:") == 0;
+}
+
+double Neural::Topology::dropoutRate(std::string const &token) {
+    std::stringstream ss(token.substr(8));
+    double rate = -1.0;
+
+    if (!(ss >> rate) || !ss.eof() || rate < 0.0 || rate >= 1.0)
+        throw Neural::InvalidTrainingFile("Invalid " + token + " in topology brief, the dropout rate must be in [0..1[");
+    return rate;
+}
+
+bool Neural::Topology::isNumber(std::string const &token) {
+    return !token.empty() && token.find_first_not_of("0123456789") == std::string::npos;
+}
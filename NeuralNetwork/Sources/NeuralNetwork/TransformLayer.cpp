@@ -0,0 +1,117 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   10/05/2018 10:31:08
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 10/05/2018 18:52:44
+ */
+
+
+#include "TransformLayer.hpp"
+
+unsigned Neural::Shape::size() const {
+    return this->channels * this->height * this->width;
+}
+
+std::string Neural::Shape::toString() const {
+    // Always at least HxW, a lone number would be read back as a fully connected layer
+    if (this->channels == 1)
+        return std::to_string(this->height) + "x" + std::to_string(this->width);
+    return std::to_string(this->channels) + "x" + std::to_string(this->height) + "x" + std::to_string(this->width);
+}
+
+Neural::Shape Neural::Shape::parse(std::string const &description) {
+    // "W", "HxW" or "CxHxW"
+    std::vector<unsigned> dims;
+    std::stringstream ss(description);
+    std::string dim;
+
+    while (getline(ss, dim, 'x')) {
+        if (dim.empty() || dim.find_first_not_of("0123456789") != std::string::npos)
+            throw Neural::InvalidTrainingFile("Invalid shape " + description + " in topology brief");
+        dims.push_back(std::stoul(dim));
+    }
+    if (dims.empty() || dims.size() > 3)
+        throw Neural::InvalidTrainingFile("Invalid shape " + description + " in topology brief");
+    while (dims.size() < 3) {
+        dims.insert(dims.begin(), 1);
+    }
+    return Shape{dims[0], dims[1], dims[2]};
+}
+
+Neural::ATransformLayer::ATransformLayer(Shape const &inputShape, Shape const &outputShape, double eta, double alpha) {
+    this->_inputShape = inputShape;
+    this->_outputShape = outputShape;
+    this->_eta = eta;
+    this->_alpha = alpha;
+    this->_output.assign(outputShape.size(), 0.0);
+    this->_inputGradients.assign(inputShape.size(), 0.0);
+}
+
+Neural::ATransformLayer::~ATransformLayer() {
+
+}
+
+Neural::ATransformLayer::ATransformLayer(const ATransformLayer &layer) {
+    this->_inputShape = layer._inputShape;
+    this->_outputShape = layer._outputShape;
+    this->_eta = layer._eta;
+    this->_alpha = layer._alpha;
+    this->_output = layer._output;
+    this->_inputGradients = layer._inputGradients;
+    this->_parameters = layer._parameters;
+}
+
+Neural::ATransformLayer &Neural::ATransformLayer::operator =(const ATransformLayer &layer) {
+    this->_inputShape = layer._inputShape;
+    this->_outputShape = layer._outputShape;
+    this->_eta = layer._eta;
+    this->_alpha = layer._alpha;
+    this->_output = layer._output;
+    this->_inputGradients = layer._inputGradients;
+    this->_parameters = layer._parameters;
+    return *this;
+}
+
+Neural::Shape const &Neural::ATransformLayer::getInputShape() const {
+    return this->_inputShape;
+}
+
+Neural::Shape const &Neural::ATransformLayer::getOutputShape() const {
+    return this->_outputShape;
+}
+
+std::vector<double> const &Neural::ATransformLayer::getOutput() const {
+    return this->_output;
+}
+
+std::vector<double> const &Neural::ATransformLayer::getInputGradients() const {
+    return this->_inputGradients;
+}
+
+std::vector<Neural::INeuron::Connection> const &Neural::ATransformLayer::getParameters() const {
+    return this->_parameters;
+}
+
+void Neural::ATransformLayer::setParameter(unsigned index, Neural::INeuron::Connection const &data) {
+    if (index >= this->_parameters.size())
+        throw Neural::InvalidSavingFile("Parameter " + std::to_string(index) + " does not exist in layer " + this->getDescription());
+    this->_parameters[index] = data;
+}
+
+void Neural::ATransformLayer::checkInput(const std::vector<double> &input) const {
+    if (input.size() != this->_inputShape.size()) {
+        throw Neural::InvalidInput("You want to input " + std::to_string(input.size()) + " values but the layer " + this->getDescription() + " can only accept " + std::to_string(this->_inputShape.size()));
+    }
+}
+
+void Neural::ATransformLayer::updateParameter(unsigned index, double gradient) {
+    // Same rule as Neuron::updateInputWeights, the gradient already holds the input factor
+    Neural::INeuron::Connection &parameter = this->_parameters[index];
+    parameter.deltaWeight = this->_eta * gradient + this->_alpha * parameter.deltaWeight;
+    parameter.weight += parameter.deltaWeight;
+}
+
+double Neural::ATransformLayer::randomWeight(Random &random, unsigned fanIn) const {
+    return random.uniform(-1.0, 1.0) / sqrt(double(fanIn));
+}
@@ -0,0 +1,45 @@
+/**
+ * @Author: Victor Sousa <vicostudio>
+ * @Date:   17/05/2018 09:48:13
+ * @Email:  victor.sousa@epitech.eu
+ * @Last modified by:   vicostudio
+ * @Last modified time: 17/05/2018 16:02:40
+ */
+
+
+#include "Workspace.hpp"
+
+Neural::Workspace::Workspace() {
+
+}
+
+Neural::Workspace::~Workspace() {
+
+}
+
+Neural::Workspace::Workspace(const Workspace &workspace) {
+    this->_buffers[0] = workspace._buffers[0];
+    this->_buffers[1] = workspace._buffers[1];
+    this->_scratch = workspace._scratch;
+    this->_output = workspace._output;
+}
+
+Neural::Workspace &Neural::Workspace::operator =(const Workspace &workspace) {
+    this->_buffers[0] = workspace._buffers[0];
+    this->_buffers[1] = workspace._buffers[1];
+    this->_scratch = workspace._scratch;
+    this->_output = workspace._output;
+    return *this;
+}
+
+std::vector<double> &Neural::Workspace::getBuffer(unsigned index) {
+    return this->_buffers[index & 1];
+}
+
+std::vector<double> &Neural::Workspace::getScratch() {
+    return this->_scratch;
+}
+
+std::vector<double> &Neural::Workspace::getOutput() {
+    return this->_output;
+}